@@ -0,0 +1,42 @@
+#ifndef __FLINT_CONF_H
+#define __FLINT_CONF_H
+
+#include "flint_common.h"
+
+#define KILO_BYTE(value)            ((value) * 1024)
+#define MEGA_BYTE(value)            ((value) * 1024 * 1024)
+
+#define FLINT_VARIANT_NAME          "POSIX FlintJVM"
+
+#define FILE_NAME_BUFF_SIZE         256
+#define FILE_READ_BUFFER_SIZE       512
+
+#define DEFAULT_STACK_SIZE          MEGA_BYTE(1)
+#define HEAP_SLAB_REGION_SIZE       MEGA_BYTE(16)
+#define TLAB_BLOCK_COUNT            16
+#define GC_NURSERY_SIZE             MEGA_BYTE(1)
+#define GC_REMEMBERED_SET_SIZE      256
+#define GC_PAUSE_BUDGET_US          0
+#define GC_STEP_SIZE                KILO_BYTE(16)
+#define GC_HEAP_BUDGET              MEGA_BYTE(64)
+#define GC_MIN_THRESHOLD            KILO_BYTE(512)
+#define GC_HEAP_GROWTH_PERCENT      100
+#define GC_MARK_STACK_SIZE          128
+
+#define HEAP_DUMP_BUFFER_SIZE       512
+#define HEAP_DUMP_ON_OOM            1
+#define HEAP_DUMP_FILE_NAME         "heap.fhpd"
+
+#define INLINE_CACHE_SIZE           2
+
+#define MAX_OF_BREAK_POINT          20
+#define DBG_TX_BUFFER_SIZE          KILO_BYTE(1)
+#define DBG_CONSOLE_BUFFER_SIZE     KILO_BYTE(1)
+
+#ifndef FLINT_API_NET_ENABLED
+#define FLINT_API_NET_ENABLED       1
+#endif
+
+#define FLINT_API_DRAW_ENABLED      0
+
+#endif /* __FLINT_CONF_H */
@@ -4,6 +4,12 @@
 #include "freertos/semphr.h"
 #include "flint_system_api.h"
 
+#if (configTASK_NOTIFICATION_ARRAY_ENTRIES < 2)
+#error "FlintAPI::Thread::park needs configTASK_NOTIFICATION_ARRAY_ENTRIES >= 2, index 0 is used by wait/notify"
+#endif
+
+#define PARK_NOTIFY_INDEX           1
+
 using namespace FlintAPI::Thread;
 
 ThreadHandle FlintAPI::Thread::create(void (*task)(void *), void *param, uint32_t stackSize) {
@@ -39,3 +45,16 @@ bool FlintAPI::Thread::wait(uint32_t ms, uint32_t *notifyValue) {
 void FlintAPI::Thread::notify(ThreadHandle handle, uint32_t notifyValue) {
     xTaskNotify((TaskHandle_t)handle, notifyValue, eSetValueWithOverwrite);
 }
+
+bool FlintAPI::Thread::park(uint32_t ms) {
+    TickType_t tick = portMAX_DELAY;
+    if(ms > 0) {
+        tick = pdMS_TO_TICKS(ms);
+        if(tick < 1) tick = 1;
+    }
+    return ulTaskNotifyTakeIndexed(PARK_NOTIFY_INDEX, pdTRUE, tick) != 0;
+}
+
+void FlintAPI::Thread::unpark(ThreadHandle handle) {
+    xTaskNotifyGiveIndexed((TaskHandle_t)handle, PARK_NOTIFY_INDEX);
+}
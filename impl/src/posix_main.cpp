@@ -0,0 +1,86 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include "flint.h"
+#include "flint_system_api.h"
+
+static Flint flint;
+static sem_t terminatedSem;
+
+static void printUsage(void) {
+    fprintf(stderr,
+        "Usage: flint [options] <jar file> [args...]\n"
+        "Options:\n"
+        "  -cp, -classpath <path list>  ':' separated list of jar files, overrides CLASSPATH\n"
+        "  -time                        print the wall time of the run to stderr\n"
+    );
+}
+
+static void terminatedCallback(Flint *flint) {
+    (void)flint;
+    sem_post(&terminatedSem);
+}
+
+static JObjectArray *newArgs(int argc, char *argv[]) {
+    JClass *strArrCls = flint.findClassOfArray(NULL, "java/lang/String", 1);
+    if(strArrCls == NULL) return NULL;
+    JObjectArray *args = (JObjectArray *)flint.newArray(NULL, strArrCls, argc);
+    if(args == NULL) return NULL;
+    args->clearArray();
+    for(int i = 0; i < argc; i++) {
+        JString *str = flint.newString(NULL, argv[i]);
+        if(str == NULL) return NULL;
+        args->getData()[i] = str;
+    }
+    return args;
+}
+
+int main(int argc, char *argv[]) {
+    bool timeRun = false;
+    int index = 1;
+    for(; index < argc && argv[index][0] == '-'; index++) {
+        if((strcmp(argv[index], "-cp") == 0 || strcmp(argv[index], "-classpath") == 0) && (index + 1) < argc)
+            setenv("CLASSPATH", argv[++index], 1);
+        else if(strcmp(argv[index], "-time") == 0)
+            timeRun = true;
+        else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if(index >= argc) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    static char cwd[FILE_NAME_BUFF_SIZE];
+    if(getcwd(cwd, sizeof(cwd)) != NULL)
+        flint.setCwd(cwd);
+
+    sem_init(&terminatedSem, 0, 0);
+    flint.terminatedCallback(terminatedCallback);
+    if(!flint.setProgram(argv[index])) {
+        fprintf(stderr, "flint: invalid jar file %s\n", argv[index]);
+        return EXIT_FAILURE;
+    }
+
+    int64_t startTime = FlintAPI::System::getTimeNanos();
+    JObjectArray *args = newArgs(argc - index - 1, &argv[index + 1]);
+    if(args == NULL || !flint.startToMain(1, args)) {
+        fprintf(stderr, "flint: could not start main class of %s\n", argv[index]);
+        return EXIT_FAILURE;
+    }
+    while(sem_wait(&terminatedSem) != 0);
+    int64_t elapsed = FlintAPI::System::getTimeNanos() - startTime;
+    fflush(stdout);
+
+    if(timeRun)
+        fprintf(stderr, "flint: %s finished in %lld.%03lld ms\n", argv[index], (long long)(elapsed / 1000000), (long long)((elapsed / 1000) % 1000));
+
+    int32_t exitCode = flint.getExitCode();
+    flint.freeAll();
+    return exitCode;
+}
@@ -0,0 +1,75 @@
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "flint.h"
+#include "flint_system_api.h"
+
+#define MAX_OF_CLASS_PATH   32
+
+static char *classPathBuff = NULL;
+static const char *classPaths[MAX_OF_CLASS_PATH + 1] = {};
+static pthread_once_t classPathOnce = PTHREAD_ONCE_INIT;
+
+static void parseClassPath(void) {
+    /* Same as the reference JVM, the class path list comes from CLASSPATH */
+    const char *env = getenv("CLASSPATH");
+    if(env == NULL || *env == 0) return;
+    classPathBuff = strdup(env);
+    if(classPathBuff == NULL) return;
+    uint32_t count = 0;
+    char *savePtr = NULL;
+    for(char *path = strtok_r(classPathBuff, ":", &savePtr); path != NULL; path = strtok_r(NULL, ":", &savePtr)) {
+        if(count < MAX_OF_CLASS_PATH)
+            classPaths[count++] = path;
+        else {
+            fprintf(stderr, "flint: too many class path entries, \"%s\" is ignored\n", path);
+            break;
+        }
+    }
+}
+
+void FlintAPI::System::reset(void) {
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+void *FlintAPI::System::malloc(uint32_t size) {
+    return ::malloc(size);
+}
+
+void *FlintAPI::System::realloc(void *p, uint32_t size) {
+    return ::realloc(p, size);
+}
+
+void FlintAPI::System::free(void *p) {
+    ::free(p);
+}
+
+void FlintAPI::System::consoleWrite(uint8_t *utf8, uint32_t length) {
+    fwrite(utf8, 1, length, stdout);
+}
+
+int64_t FlintAPI::System::getTimeNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t FlintAPI::System::getTimeMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+const char *FlintAPI::System::getClassPath(uint32_t index) {
+    pthread_once(&classPathOnce, parseClassPath);
+    return (index < MAX_OF_CLASS_PATH) ? classPaths[index] : NULL;
+}
+
+JNMPtr FlintAPI::System::findNativeMethod(MethodInfo *methodInfo) {
+    (void)methodInfo;
+    return NULL;
+}
@@ -0,0 +1,221 @@
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "flint.h"
+#include "flint_common.h"
+#include "flint_system_api.h"
+
+using namespace FlintAPI::IO;
+
+typedef struct {
+    DIR *dir;
+    char path[FILE_NAME_BUFF_SIZE];
+} PosixDir;
+
+static FileResult convertFileResult(int err) {
+    switch(err) {
+        case 0:
+            return FILE_RESULT_OK;
+        case ENOENT:
+        case ENOTDIR:
+        case ENAMETOOLONG:
+            return FILE_RESULT_NO_PATH;
+        case EACCES:
+        case EPERM:
+        case EISDIR:
+        case ENOTEMPTY:
+            return FILE_RESULT_DENIED;
+        case EEXIST:
+            return FILE_RESULT_EXIST;
+        case EROFS:
+            return FILE_RESULT_WRITE_PROTECTED;
+        case EBUSY:
+            return FILE_RESULT_BUSY;
+        case EMFILE:
+        case ENFILE:
+            return FILE_RESULT_TOO_MANY_OPEN_FILES;
+        default:
+            return FILE_RESULT_ERR;
+    }
+}
+
+static int toFd(FileHandle handle) {
+    return (int)((intptr_t)handle - 1);
+}
+
+static FileHandle toHandle(int fd) {
+    return (FileHandle)((intptr_t)fd + 1);
+}
+
+static void convertFileInfo(const char *name, struct stat *st, FileInfo *fileInfo) {
+    fileInfo->attribute = 0;
+    fileInfo->readOnly = (st->st_mode & S_IWUSR) ? 0 : 1;
+    fileInfo->hidden = (name[0] == '.') ? 1 : 0;
+    fileInfo->directory = S_ISDIR(st->st_mode) ? 1 : 0;
+    fileInfo->archive = S_ISREG(st->st_mode) ? 1 : 0;
+    fileInfo->size = (fileInfo->directory) ? 0 : (uint32_t)st->st_size;
+    fileInfo->time = (uint64_t)st->st_mtime;
+}
+
+static FileResult copyName(const char *name, FileInfo *fileInfo) {
+    uint16_t index = 0;
+    while(name[index] != 0) {
+        if(index < (sizeof(fileInfo->name) - 1)) {
+            fileInfo->name[index] = name[index];
+            index++;
+        }
+        else
+            return FILE_RESULT_ERR;
+    }
+    fileInfo->name[index] = 0;
+    return FILE_RESULT_OK;
+}
+
+FileResult FlintAPI::IO::finfo(const char *fileName, FileInfo *fileInfo) {
+    struct stat st;
+    if(stat(fileName, &st) != 0)
+        return convertFileResult(errno);
+    if(fileInfo != NULL) {
+        const char *name = strrchr(fileName, '/');
+        name = (name != NULL) ? (name + 1) : fileName;
+        convertFileInfo(name, &st, fileInfo);
+        return copyName(name, fileInfo);
+    }
+    return FILE_RESULT_OK;
+}
+
+FileHandle FlintAPI::IO::fopen(const char *fileName, FileMode mode) {
+    int flags;
+    if((mode & (FILE_MODE_READ | FILE_MODE_WRITE)) == (FILE_MODE_READ | FILE_MODE_WRITE))
+        flags = O_RDWR;
+    else if(mode & FILE_MODE_WRITE)
+        flags = O_WRONLY;
+    else
+        flags = O_RDONLY;
+    if((mode & FILE_MODE_APPEND) == FILE_MODE_APPEND)
+        flags |= O_CREAT | O_APPEND;
+    else if(mode & FILE_MODE_OPEN_ALWAYS)
+        flags |= O_CREAT;
+    else if(mode & FILE_MODE_CREATE_ALWAYS)
+        flags |= O_CREAT | O_TRUNC;
+    else if(mode & FILE_MODE_CREATE_NEW)
+        flags |= O_CREAT | O_EXCL;
+    int fd = ::open(fileName, flags, 0666);
+    if(fd < 0) return NULL;
+    return toHandle(fd);
+}
+
+FileResult FlintAPI::IO::fread(FileHandle handle, void *buff, uint32_t btr, uint32_t *br) {
+    ssize_t ret;
+    do {
+        ret = ::read(toFd(handle), buff, btr);
+    } while(ret < 0 && errno == EINTR);
+    if(ret < 0) {
+        *br = 0;
+        return convertFileResult(errno);
+    }
+    *br = (uint32_t)ret;
+    return FILE_RESULT_OK;
+}
+
+FileResult FlintAPI::IO::fwrite(FileHandle handle, void *buff, uint32_t btw, uint32_t *bw) {
+    ssize_t ret;
+    do {
+        ret = ::write(toFd(handle), buff, btw);
+    } while(ret < 0 && errno == EINTR);
+    if(ret < 0) {
+        *bw = 0;
+        return convertFileResult(errno);
+    }
+    *bw = (uint32_t)ret;
+    return FILE_RESULT_OK;
+}
+
+uint32_t FlintAPI::IO::fsize(FileHandle handle) {
+    struct stat st;
+    if(fstat(toFd(handle), &st) != 0) return 0;
+    return (uint32_t)st.st_size;
+}
+
+uint32_t FlintAPI::IO::ftell(FileHandle handle) {
+    return (uint32_t)lseek(toFd(handle), 0, SEEK_CUR);
+}
+
+FileResult FlintAPI::IO::fseek(FileHandle handle, uint32_t offset) {
+    if(lseek(toFd(handle), (off_t)offset, SEEK_SET) < 0)
+        return convertFileResult(errno);
+    return FILE_RESULT_OK;
+}
+
+FileResult FlintAPI::IO::fsync(FileHandle handle) {
+    return (::fsync(toFd(handle)) == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+}
+
+FileResult FlintAPI::IO::ftruncate(FileHandle handle, uint32_t length) {
+    return (::ftruncate(toFd(handle), (off_t)length) == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+}
+
+FileResult FlintAPI::IO::fclose(FileHandle handle) {
+    if(handle != NULL)
+        return (::close(toFd(handle)) == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+    return FILE_RESULT_OK;
+}
+
+FileResult FlintAPI::IO::fremove(const char *fileName) {
+    return (::remove(fileName) == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+}
+
+FileResult FlintAPI::IO::frename(const char *oldName, const char *newName) {
+    return (::rename(oldName, newName) == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+}
+
+DirHandle FlintAPI::IO::opendir(const char *dirName) {
+    if(strlen(dirName) >= FILE_NAME_BUFF_SIZE) return NULL;
+    PosixDir *dir = (PosixDir *)FlintAPI::System::malloc(sizeof(PosixDir));
+    if(dir == NULL) return NULL;
+    dir->dir = ::opendir(dirName);
+    if(dir->dir == NULL) {
+        FlintAPI::System::free(dir);
+        return NULL;
+    }
+    strcpy(dir->path, dirName);
+    return (void *)dir;
+}
+
+FileResult FlintAPI::IO::readdir(DirHandle handle, FileInfo *fileInfo) {
+    PosixDir *dir = (PosixDir *)handle;
+    struct dirent *ent;
+    do {
+        errno = 0;
+        ent = ::readdir(dir->dir);
+        if(ent == NULL) {
+            /* End of directory is reported as an empty name, same as FatFs */
+            fileInfo->name[0] = 0;
+            return convertFileResult(errno);
+        }
+    } while(strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0);
+
+    char path[FILE_NAME_BUFF_SIZE * 2];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", dir->path, ent->d_name);
+    if(stat(path, &st) != 0)
+        return convertFileResult(errno);
+    convertFileInfo(ent->d_name, &st, fileInfo);
+    return copyName(ent->d_name, fileInfo);
+}
+
+FileResult FlintAPI::IO::closedir(DirHandle handle) {
+    PosixDir *dir = (PosixDir *)handle;
+    int ret = ::closedir(dir->dir);
+    FlintAPI::System::free(dir);
+    return (ret == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+}
+
+FileResult FlintAPI::IO::mkdir(const char *path) {
+    return (::mkdir(path, 0777) == 0) ? FILE_RESULT_OK : convertFileResult(errno);
+}
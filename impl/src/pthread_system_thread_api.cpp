@@ -0,0 +1,196 @@
+
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "flint_system_api.h"
+
+using namespace FlintAPI::Thread;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool notified;
+    bool parkPermit;
+    uint32_t notifyValue;
+    void (*task)(void *);
+    void *param;
+    uint32_t refCount;          /* The thread itself and the VM, see FlintAPI::Thread::release */
+} PosixThread;
+
+static pthread_key_t threadKey;
+static pthread_once_t threadKeyOnce = PTHREAD_ONCE_INIT;
+
+static void freeThread(void *p) {
+    PosixThread *th = (PosixThread *)p;
+    pthread_cond_destroy(&th->cond);
+    pthread_mutex_destroy(&th->mutex);
+    ::free(th);
+}
+
+static void releaseThread(PosixThread *th) {
+    if(__atomic_sub_fetch(&th->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+        freeThread(th);
+}
+
+static void exitThread(void *p) {
+    releaseThread((PosixThread *)p);
+}
+
+static void createThreadKey(void) {
+    pthread_key_create(&threadKey, exitThread);
+}
+
+static PosixThread *newThread(void (*task)(void *), void *param) {
+    PosixThread *th = (PosixThread *)::malloc(sizeof(PosixThread));
+    if(th == NULL) return NULL;
+    pthread_mutex_init(&th->mutex, NULL);
+    pthread_cond_init(&th->cond, NULL);
+    th->notified = false;
+    th->parkPermit = false;
+    th->notifyValue = 0;
+    th->task = task;
+    th->param = param;
+    th->refCount = 1;
+    return th;
+}
+
+static void *threadEntry(void *p) {
+    PosixThread *th = (PosixThread *)p;
+    pthread_setspecific(threadKey, th);
+    th->task(th->param);
+    return NULL;
+}
+
+ThreadHandle FlintAPI::Thread::create(void (*task)(void *), void *param, uint32_t stackSize) {
+    pthread_once(&threadKeyOnce, createThreadKey);
+    PosixThread *th = newThread(task, param);
+    if(th == NULL) return NULL;
+    /* The handle returned to the VM keeps it alive after the thread exits, until release is called */
+    th->refCount = 2;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if(stackSize)
+        pthread_attr_setstacksize(&attr, (stackSize < (uint32_t)PTHREAD_STACK_MIN) ? (uint32_t)PTHREAD_STACK_MIN : stackSize);
+    int ret = pthread_create(&th->thread, &attr, threadEntry, th);
+    pthread_attr_destroy(&attr);
+    if(ret != 0) {
+        freeThread(th);
+        return NULL;
+    }
+    return (void *)th;
+}
+
+ThreadHandle FlintAPI::Thread::getCurrentThread(void) {
+    pthread_once(&threadKeyOnce, createThreadKey);
+    PosixThread *th = (PosixThread *)pthread_getspecific(threadKey);
+    if(th == NULL) {
+        /* Threads not created by FlintAPI::Thread::create (e.g. the main thread) */
+        th = newThread(NULL, NULL);
+        if(th == NULL) return NULL;
+        th->thread = pthread_self();
+        pthread_setspecific(threadKey, th);
+    }
+    return (void *)th;
+}
+
+void FlintAPI::Thread::terminate(ThreadHandle handle) {
+    if(handle == NULL || handle == getCurrentThread())
+        pthread_exit(NULL);
+    pthread_cancel(((PosixThread *)handle)->thread);
+}
+
+void FlintAPI::Thread::sleep(uint32_t ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000;
+    while(nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+void FlintAPI::Thread::yield(void) {
+    sched_yield();
+}
+
+bool FlintAPI::Thread::wait(uint32_t ms, uint32_t *notifyValue) {
+    PosixThread *th = (PosixThread *)getCurrentThread();
+    pthread_mutex_lock(&th->mutex);
+    if(ms > 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += ms / 1000;
+        ts.tv_nsec += (ms % 1000) * 1000000;
+        if(ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        while(!th->notified) {
+            if(pthread_cond_timedwait(&th->cond, &th->mutex, &ts) == ETIMEDOUT)
+                break;
+        }
+    }
+    else {
+        while(!th->notified)
+            pthread_cond_wait(&th->cond, &th->mutex);
+    }
+    bool ret = th->notified;
+    if(ret && notifyValue != NULL)
+        *notifyValue = th->notifyValue;
+    th->notified = false;
+    pthread_mutex_unlock(&th->mutex);
+    return ret;
+}
+
+void FlintAPI::Thread::notify(ThreadHandle handle, uint32_t notifyValue) {
+    if(handle == NULL) return;
+    PosixThread *th = (PosixThread *)handle;
+    pthread_mutex_lock(&th->mutex);
+    th->notifyValue = notifyValue;
+    th->notified = true;
+    pthread_cond_signal(&th->cond);
+    pthread_mutex_unlock(&th->mutex);
+}
+
+bool FlintAPI::Thread::park(uint32_t ms) {
+    PosixThread *th = (PosixThread *)getCurrentThread();
+    pthread_mutex_lock(&th->mutex);
+    if(ms > 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += ms / 1000;
+        ts.tv_nsec += (ms % 1000) * 1000000;
+        if(ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        while(!th->parkPermit) {
+            if(pthread_cond_timedwait(&th->cond, &th->mutex, &ts) == ETIMEDOUT)
+                break;
+        }
+    }
+    else {
+        while(!th->parkPermit)
+            pthread_cond_wait(&th->cond, &th->mutex);
+    }
+    bool ret = th->parkPermit;
+    th->parkPermit = false;
+    pthread_mutex_unlock(&th->mutex);
+    return ret;
+}
+
+void FlintAPI::Thread::unpark(ThreadHandle handle) {
+    if(handle == NULL) return;
+    PosixThread *th = (PosixThread *)handle;
+    pthread_mutex_lock(&th->mutex);
+    th->parkPermit = true;
+    pthread_cond_signal(&th->cond);
+    pthread_mutex_unlock(&th->mutex);
+}
+
+void FlintAPI::Thread::release(ThreadHandle handle) {
+    if(handle == NULL) return;
+    releaseThread((PosixThread *)handle);
+}
@@ -0,0 +1,13 @@
+
+#ifndef __FLINT_NATIVE_GC_STATS_H
+#define __FLINT_NATIVE_GC_STATS_H
+
+#include "flint_native.h"
+
+jint NativeGcStats_Read(FNIEnv *env, jlongArray stats);
+
+inline constexpr NativeMethod gcStatsMethods[] = {
+    NATIVE_METHOD("read", "([J)I", NativeGcStats_Read),
+};
+
+#endif /* __FLINT_NATIVE_GC_STATS_H */
@@ -0,0 +1,17 @@
+
+#ifndef __FLINT_NATIVE_RUNTIME_H
+#define __FLINT_NATIVE_RUNTIME_H
+
+#include "flint_native.h"
+
+jlong NativeRuntime_TotalMemory(FNIEnv *env, jobject obj);
+jlong NativeRuntime_FreeMemory(FNIEnv *env, jobject obj);
+jvoid NativeRuntime_Gc(FNIEnv *env, jobject obj);
+
+inline constexpr NativeMethod runtimeMethods[] = {
+    NATIVE_METHOD("totalMemory", "()J", NativeRuntime_TotalMemory),
+    NATIVE_METHOD("freeMemory",  "()J", NativeRuntime_FreeMemory),
+    NATIVE_METHOD("gc",          "()V", NativeRuntime_Gc),
+};
+
+#endif /* __FLINT_NATIVE_RUNTIME_H */
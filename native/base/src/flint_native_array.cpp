@@ -383,7 +383,10 @@ jvoid NativeArray_Set(FNIEnv *env, jobject obj, jint index, jobject v) {
             }
         }
     }
-    else ((jobjectArray)obj)->getData()[index] = v;
+    else {
+        ((jobjectArray)obj)->getData()[index] = v;
+        env->writeBarrier(obj, v);
+    }
 }
 
 jvoid NativeArray_SetBoolean(FNIEnv *env, jobject obj, jint index, jbool v) {
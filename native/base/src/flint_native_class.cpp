@@ -80,7 +80,7 @@ jstring NativeClass_InitClassName(FNIEnv *env, jclass cls) {
     }
     buff[idx] = 0;
     jstring str = ((FExec *)env)->getFlint()->getConstString((FExec *)env, buff);
-    env->setObjField(env->getFieldId(cls, "name"), str);
+    env->setObjField(cls, env->getFieldId(cls, "name"), str);
     return str;
 }
 
@@ -261,7 +261,7 @@ jobjectArray NativeClass_GetDeclaredFields0(FNIEnv *env, jclass cls) {
 
             jobject field = env->newObject(fieldCls, ctorId, cls, name, type, (int32_t)fieldInfo->accessFlag & 0x1FFF);
             if(field == NULL) break;
-            env->setIntField(env->getFieldId(field, "entry"), i);
+            env->setIntField(field, env->getFieldId(field, "entry"), i);
 
             array->getData()[i] = field;
             isOk = true;
@@ -317,7 +317,7 @@ jobjectArray NativeClass_GetDeclaredMethods0(FNIEnv *env, jclass cls) {
                 etypes->clearProtected();
                 break;
             }
-            env->setIntField(env->getFieldId(method, "entry"), (int32_t)methodInfo);
+            env->setIntField(method, env->getFieldId(method, "entry"), (int32_t)methodInfo);
 
             array->getData()[aidx++] = method;
             isOk = true;
@@ -364,7 +364,7 @@ jobjectArray NativeClass_GetDeclaredConstructors0(FNIEnv *env, jclass cls) {
                 etypes->clearProtected();
                 break;
             }
-            env->setIntField(env->getFieldId(ctor, "entry"), (int32_t)methodInfo);
+            env->setIntField(ctor, env->getFieldId(ctor, "entry"), (int32_t)methodInfo);
 
             array->getData()[aidx++] = ctor;
             isOk = true;
@@ -0,0 +1,38 @@
+
+#include "flint.h"
+#include "flint_array_object.h"
+#include "flint_native_gc_stats.h"
+
+/*
+ * Fills stats with the GcStats counters, in the order they are declared (the same order DBG_CMD_READ_GC_STATS
+ * sends them). A shorter array gets the leading ones. Returns the number of counters available
+ */
+jint NativeGcStats_Read(FNIEnv *env, jlongArray stats) {
+    GcStats gcStats;
+    ((FExec *)env)->getFlint()->getGcStats(&gcStats);
+    const jlong values[] = {
+        gcStats.minorCount,
+        gcStats.fullCount,
+        gcStats.pauseCount,
+        gcStats.lastPauseUs,
+        gcStats.maxPauseUs,
+        (jlong)gcStats.totalPauseUs,
+        gcStats.lastFreedBytes,
+        gcStats.lastFreedObjects,
+        (jlong)gcStats.totalFreedBytes,
+        (jlong)gcStats.totalFreedObjects,
+        (jlong)gcStats.totalAllocatedBytes,
+        gcStats.allocationRate,
+        gcStats.liveBytes,
+        gcStats.usedBytes,
+        gcStats.gcThreshold,
+        gcStats.heapBlocks,
+    };
+    if(stats != NULL) {
+        uint32_t count = stats->getLength();
+        if(count > LENGTH(values)) count = LENGTH(values);
+        for(uint32_t i = 0; i < count; i++)
+            stats->getData()[i] = values[i];
+    }
+    return LENGTH(values);
+}
@@ -43,11 +43,9 @@ jobject NativeMethod_Invoke0(FNIEnv *env, jobject thisObj, jobject obj, jobjectA
     else {
         Flint *flint = exec->getFlint();
         JClass *objType = obj->type != NULL ? obj->type : flint->getClassOfClass(exec);
-        if(methodInfo->loader != objType->getClassLoader()) {
-            methodInfo = flint->findMethod(exec, objType, &methodInfo->nameAndType);
-            if(methodInfo == NULL) return NULL;
-            thisObj->getFieldByIndex(0)->setInt32((int32_t)methodInfo);
-        }
+        if(objType == NULL) return NULL;
+        methodInfo = objType->getClassLoader()->getVirtualMethod(exec, methodInfo);
+        if(methodInfo == NULL) return NULL;
         ret = exec->callMethod(methodInfo, argSlot);
     }
     if(exec->hasTerminateRequest())
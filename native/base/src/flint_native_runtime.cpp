@@ -0,0 +1,27 @@
+
+#include "flint.h"
+#include "flint_native_runtime.h"
+
+/* There is no fixed heap, the total is the GC budget or what is in use if the heap has grown past it */
+static jlong getTotalMemory(GcStats *stats) {
+    return (stats->usedBytes > GC_HEAP_BUDGET) ? stats->usedBytes : GC_HEAP_BUDGET;
+}
+
+jlong NativeRuntime_TotalMemory(FNIEnv *env, jobject obj) {
+    (void)obj;
+    GcStats stats;
+    ((FExec *)env)->getFlint()->getGcStats(&stats);
+    return getTotalMemory(&stats);
+}
+
+jlong NativeRuntime_FreeMemory(FNIEnv *env, jobject obj) {
+    (void)obj;
+    GcStats stats;
+    ((FExec *)env)->getFlint()->getGcStats(&stats);
+    return getTotalMemory(&stats) - stats.usedBytes;
+}
+
+jvoid NativeRuntime_Gc(FNIEnv *env, jobject obj) {
+    (void)obj;
+    ((FExec *)env)->getFlint()->gc();
+}
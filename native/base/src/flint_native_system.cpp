@@ -25,6 +25,7 @@ jvoid NativeSystem_setOut0(FNIEnv *env, jobject out) {
     FieldValue *outField = sysCls->getClassLoader()->getStaticField((FExec *)env, "out");
     if(outField == NULL) return;
     outField->setObj(out);
+    ((FExec *)env)->getFlint()->staticWriteBarrier(sysCls->getClassLoader(), out);
 }
 
 jlong NativeSystem_CurrentTimeMillis(FNIEnv *env) {
@@ -117,6 +118,7 @@ jvoid NativeSystem_Arraycopy(FNIEnv *env, jobject src, jint srcPos, jobject dest
                 return env->throwNew(env->findClass("java/lang/ArrayStoreException"), msg, len1, name1, len2, name2);
             }
             dstVal[i] = item;
+            env->writeBarrier(dest, item);
         }
     }
     else {
@@ -124,6 +126,11 @@ jvoid NativeSystem_Arraycopy(FNIEnv *env, jobject src, jint srcPos, jobject dest
         uint8_t *dstVal = (uint8_t *)((jarray)dest)->getData();
         uint8_t compSz = ((jarray)src)->componentSize();
         memmove(dstVal + destPos * compSz, srcVal + srcPos * compSz, length * compSz);
+        if(!((jarray)dest)->isArrayOfPrimative()) {
+            jobject *items = &((jobjectArray)dest)->getData()[destPos];
+            for(int32_t i = 0; i < length; i++)
+                env->writeBarrier(dest, items[i]);
+        }
     }
 }
 
@@ -154,6 +161,5 @@ jvoid NativeSystem_Exit(FNIEnv *env, jint status) {
 }
 
 jvoid NativeSystem_Gc(FNIEnv *env) {
-    (void)env;
-    // TODO
+    ((FExec *)env)->getFlint()->gc();
 }
@@ -41,9 +41,7 @@ jvoid NativeThread_SetPriority0(FNIEnv *env, jthread thread, jint newPriority) {
 }
 
 jvoid NativeThread_Interrupt0(FNIEnv *env, jthread thread) {
-    (void)env;
-    FlintAPI::Thread::ThreadHandle handle = thread->getHandle();
-    FlintAPI::Thread::notify(handle, (uint32_t)handle);
+    ((FExec *)env)->getFlint()->interruptThread(thread);
 }
 
 jthread NativeThread_CurrentThread(FNIEnv *env) {
@@ -23,6 +23,8 @@
 #include "flint_native_file_output_stream.h"
 #include "flint_native_random_access_file.h"
 #include "flint_native_crc32.h"
+#include "flint_native_runtime.h"
+#include "flint_native_gc_stats.h"
 
 #if FLINT_API_NET_ENABLED
 #include "flint_native_flint_socket_impl.h"
@@ -57,6 +59,8 @@ static constexpr NativeClass BASE_NATIVE_CLASS_LIST[] = {
     NATIVE_CLASS("java/io/RandomAccessFile",          randomAccessFileMethods),
     NATIVE_CLASS("jdk/internal/reflect/Reflection",   reflectionMethods),
     NATIVE_CLASS("java/util/zip/CRC32",               crc32Methods),
+    NATIVE_CLASS("java/lang/Runtime",                 runtimeMethods),
+    NATIVE_CLASS("flint/lang/GcStats",                gcStatsMethods),
 
 #if FLINT_API_NET_ENABLED
     NATIVE_CLASS("flint/net/FlintSocketImpl",         flintSocketImplMethods),
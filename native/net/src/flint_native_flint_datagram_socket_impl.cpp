@@ -49,7 +49,7 @@ jvoid NativeFlintDatagramSocketImpl_Bind(FNIEnv *env, jobject obj, jint lport, j
     if(bind(sock, &addr) != SOCK_OK)
         env->throwNew(env->findClass("java/io/IOException"), "Bind error");
     else
-        env->setIntField(env->getFieldId(obj, "localPort"), lport);
+        env->setIntField(obj, env->getFieldId(obj, "localPort"), lport);
 }
 
 jvoid NativeFlintDatagramSocketImpl_Send(FNIEnv *env, jobject obj, jobject p) {
@@ -118,7 +118,7 @@ jvoid NativeFlintDatagramSocketImpl_Receive(FNIEnv *env, jobject obj, jobject p)
 
     if(!CheckArrayIndexSize(env, b, off, len)) return;
 
-    int32_t timeout = env->getIntField(env->getFieldId(obj, "timeout"));
+    int32_t timeout = env->getIntField(obj, env->getFieldId(obj, "timeout"));
     uint64_t startTime = getTimeMillis();
 
     while(!env->hasTerminateRequest() && (timeout <= 0 || ((uint64_t)(getTimeMillis() - startTime)) < timeout)) {
@@ -129,6 +129,7 @@ jvoid NativeFlintDatagramSocketImpl_Receive(FNIEnv *env, jobject obj, jobject p)
             InetAddress *inetAddr = NativeFlintSocketImpl_CreateInetAddress(env, &addr);
             if(inetAddr == NULL) return;
             packet->setAddress(inetAddr);
+            env->writeBarrier(packet, inetAddr);
             inetAddr->clearProtected();
             if(inetAddr->getFamily() == NET_INET6)
                 ((Inet6Address *)inetAddr)->getAddress()->clearProtected();
@@ -196,12 +197,12 @@ jvoid NativeFlintDatagramSocketImpl_DatagramSocketCreate(FNIEnv *env, jobject ob
     int32_t sock = socket(false);
     Hook *hook = sock == -1 ? NULL : exec->getFlint()->addShutdownHook(exec, (void *)sock, NativeFlintSocketImpl_SocketClose);
     if(hook == NULL) {
-        if(sock != -1) close(sock);
+        if(sock != -1) FlintAPI::Net::close(sock);
         env->throwNew(env->findClass("java/io/IOException"), "Create DatagramSocket error");
         return;
     }
-    jobject fdObj = env->getObjField(env->getFieldId(obj, "fd"));
-    env->setIntField(env->getFieldId(fdObj, "fd"), (int32_t)hook);
+    jobject fdObj = env->getObjField(obj, env->getFieldId(obj, "fd"));
+    env->setIntField(fdObj, env->getFieldId(fdObj, "fd"), (int32_t)hook);
 }
 
 jvoid NativeFlintDatagramSocketImpl_DatagramSocketClose(FNIEnv *env, jobject obj) {
@@ -46,13 +46,13 @@ jbool ConvertToSockAddr(InetAddress *inetAddr, jint port, SockAddr *addr) {
 }
 
 Hook *NativeFlintSocketImpl_GetHook(FNIEnv *env, jobject socketObj, bool throwable) {
-    jobject fdObj = env->getObjField(env->getFieldId(socketObj, "fd"));
+    jobject fdObj = env->getObjField(socketObj, env->getFieldId(socketObj, "fd"));
     if(fdObj == NULL) {
         if(throwable)
             env->throwNew(env->findClass("java/io/IOException"), "Socket has not been created");
         return NULL;
     }
-    int32_t fd = env->getIntField(env->getFieldId(fdObj, "fd"));
+    int32_t fd = env->getIntField(fdObj, env->getFieldId(fdObj, "fd"));
     if(fd == -1 || (Hook *)fd == NULL) {
         if(throwable)
             env->throwNew(env->findClass("java/io/IOException"), "Socket has not been created");
@@ -118,7 +118,7 @@ InetAddress *NativeFlintSocketImpl_CreateInetAddress(FNIEnv *env, SockAddr *addr
 }
 
 void NativeFlintSocketImpl_SocketClose(void *handle) {
-    close((int32_t)handle);
+    FlintAPI::Net::close((int32_t)handle);
 }
 
 jvoid NativeFlintSocketImpl_SocketCreate(FNIEnv *env, jobject obj) {
@@ -126,12 +126,12 @@ jvoid NativeFlintSocketImpl_SocketCreate(FNIEnv *env, jobject obj) {
     int32_t sock = socket(true);
     Hook *hook = sock == -1 ? NULL : exec->getFlint()->addShutdownHook(exec, (void *)sock, NativeFlintSocketImpl_SocketClose);
     if(hook == NULL) {
-        if(sock != -1) close(sock);
+        if(sock != -1) FlintAPI::Net::close(sock);
         env->throwNew(env->findClass("java/io/IOException"), "Create socket error");
         return;
     }
-    jobject fdObj = env->getObjField(env->getFieldId(obj, "fd"));
-    env->setIntField(env->getFieldId(fdObj, "fd"), (int32_t)hook);
+    jobject fdObj = env->getObjField(obj, env->getFieldId(obj, "fd"));
+    env->setIntField(fdObj, env->getFieldId(fdObj, "fd"), (int32_t)hook);
 }
 
 jvoid NativeFlintSocketImpl_SocketConnect(FNIEnv *env, jobject obj, jobject address, jint port) {
@@ -186,7 +186,7 @@ jvoid NativeFlintSocketImpl_SocketAccept(FNIEnv *env, jobject obj, jobject s) {
     if(listenSock == -1) return;
 
     SockAddr addr;
-    int32_t timeout = env->getIntField(env->getFieldId(obj, "timeout"));
+    int32_t timeout = env->getIntField(obj, env->getFieldId(obj, "timeout"));
     uint64_t startTime = getTimeMillis();
 
     while(!env->hasTerminateRequest() && (timeout <= 0 || ((uint64_t)(getTimeMillis() - startTime)) < timeout)) {
@@ -201,18 +201,19 @@ jvoid NativeFlintSocketImpl_SocketAccept(FNIEnv *env, jobject obj, jobject s) {
             Hook *hook = exec->getFlint()->addShutdownHook(exec, (void *)client, NativeFlintSocketImpl_SocketClose);
             if(hook == NULL) {
                 env->throwNew(env->findClass("java/io/IOException"), "Accept error");
-                close(client);
+                FlintAPI::Net::close(client);
                 return;
             }
             InetAddress *inetAddr = NativeFlintSocketImpl_CreateInetAddress(env, &addr);
             if(inetAddr == NULL) return;
-            env->setObjField(env->getFieldId(s, "address"), inetAddr);
+            env->setObjField(s, env->getFieldId(s, "address"), inetAddr);
             inetAddr->clearProtected();
             if(inetAddr->getFamily() == NET_INET6)
                 ((Inet6Address *)inetAddr)->getAddress()->clearProtected();
-            env->setIntField(env->getFieldId(env->getObjField(env->getFieldId(s, "fd")), "fd"), (int32_t)hook);
-            env->setIntField(env->getFieldId(s, "port"), env->getIntField(env->getFieldId(obj, "port")));
-            env->setIntField(env->getFieldId(s, "localport"), env->getIntField(env->getFieldId(obj, "localport")));
+            jobject fdObj = env->getObjField(s, env->getFieldId(s, "fd"));
+            env->setIntField(fdObj, env->getFieldId(fdObj, "fd"), (int32_t)hook);
+            env->setIntField(s, env->getFieldId(s, "port"), env->getIntField(obj, env->getFieldId(obj, "port")));
+            env->setIntField(s, env->getFieldId(s, "localport"), env->getIntField(obj, env->getFieldId(obj, "localport")));
             return;
         }
     }
@@ -267,7 +268,7 @@ jobject NativeFlintSocketImpl_SocketGetOption(FNIEnv *env, jobject obj, jint opt
         case NATIVE_SO_TIMEOUT: {
             jobject ret = env->newObject(env->findClass("java/lang/Integer"));
             if(ret == NULL) return NULL;
-            ret->getFieldByIndex(0)->setInt32(env->getIntField(env->getFieldId(obj, "timeout")));
+            ret->getFieldByIndex(0)->setInt32(env->getIntField(obj, env->getFieldId(obj, "timeout")));
             return ret;
         }
         case NATIVE_TCP_NODELAY: {
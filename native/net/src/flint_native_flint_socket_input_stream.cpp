@@ -17,8 +17,8 @@ jint NativeFlintSocketInputStream_SocketRead(FNIEnv *env, jobject obj, jbyteArra
 
     if(!CheckArrayIndexSize(env, b, off, len)) return -1;
 
-    jobject impl = env->getObjField(env->getFieldId(obj, "impl"));
-    int32_t timeout = env->getIntField(env->getFieldId(impl, "timeout"));
+    jobject impl = env->getObjField(obj, env->getFieldId(obj, "impl"));
+    int32_t timeout = env->getIntField(impl, env->getFieldId(impl, "timeout"));
     uint64_t startTime = getTimeMillis();
 
     while(!env->hasTerminateRequest() && (timeout <= 0 || ((uint64_t)(getTimeMillis() - startTime)) < timeout)) {
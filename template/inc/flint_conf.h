@@ -7,9 +7,25 @@
 #include "flint_common.h"
 
 #define FILE_NAME_BUFF_SIZE         256
+#define FILE_READ_BUFFER_SIZE       512
 
 #define DEFAULT_STACK_SIZE          MEGA_BYTE(1)
-#define OBJECT_COUNT_TO_GC          10000
+#define HEAP_SLAB_REGION_SIZE       KILO_BYTE(128)
+#define TLAB_BLOCK_COUNT            16
+#define GC_NURSERY_SIZE             KILO_BYTE(64)
+#define GC_REMEMBERED_SET_SIZE      256
+#define GC_PAUSE_BUDGET_US          0
+#define GC_STEP_SIZE                KILO_BYTE(16)
+#define GC_HEAP_BUDGET              MEGA_BYTE(2)
+#define GC_MIN_THRESHOLD            KILO_BYTE(64)
+#define GC_HEAP_GROWTH_PERCENT      100
+#define GC_MARK_STACK_SIZE          128
+
+#define HEAP_DUMP_BUFFER_SIZE       512
+#define HEAP_DUMP_ON_OOM            0
+#define HEAP_DUMP_FILE_NAME         "heap.fhpd"
+
+#define INLINE_CACHE_SIZE           2
 
 #define MAX_OF_BREAK_POINT          20
 #define DBG_TX_BUFFER_SIZE          KILO_BYTE(1)
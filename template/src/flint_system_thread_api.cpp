@@ -30,3 +30,15 @@ bool FlintAPI::Thread::wait(uint32_t ms, uint32_t *notifyValue) {
 void FlintAPI::Thread::notify(ThreadHandle handle, uint32_t notifyValue) {
     #error "FlintAPI::Thread::notify is not implemented in VM";
 }
+
+bool FlintAPI::Thread::park(uint32_t ms) {
+    #error "FlintAPI::Thread::park is not implemented in VM";
+}
+
+void FlintAPI::Thread::unpark(ThreadHandle handle) {
+    #error "FlintAPI::Thread::unpark is not implemented in VM";
+}
+
+void FlintAPI::Thread::release(ThreadHandle handle) {
+    #error "FlintAPI::Thread::release is not implemented in VM";
+}
@@ -0,0 +1,45 @@
+
+/*
+ * Casting between interface array types links the interfaces involved. Linking must not give an interface a vtable,
+ * which would overwrite the itable slots of its methods and break every invokeinterface through it afterwards
+ */
+public class InterfaceArrayCast {
+    interface Shape {
+        int area();
+    }
+
+    interface Polygon extends Shape {
+        String name();
+        int sides();
+    }
+
+    static class Square implements Polygon {
+        private final int size;
+
+        Square(int size) {
+            this.size = size;
+        }
+
+        public int area() {
+            return size * size;
+        }
+
+        public String name() {
+            return "square";
+        }
+
+        public int sides() {
+            return 4;
+        }
+    }
+
+    public static void main(String[] args) {
+        Object array = new Polygon[] { new Square(3) };
+        Shape[] shapes = (Shape[])array;
+        Polygon polygon = (Polygon)shapes[0];
+        if(!Shape.class.isAssignableFrom(Polygon.class))
+            System.exit(1);
+        if(shapes[0].area() != 9 || polygon.sides() != 4 || !polygon.name().equals("square"))
+            System.exit(2);
+    }
+}
@@ -17,10 +17,54 @@
 #include "flint_utf8_dict_node.h"
 #include "flint_java_class_dict_node.h"
 #include "flint_java_string_dict_node.h"
+#include "flint_zip_index.h"
+#include "flint_file_dict_node.h"
+#include "flint_heap.h"
 
+typedef enum : uint8_t {
+    GC_IDLE,
+    GC_MARKING,
+    GC_SWEEPING,
+} GcPhase;
+
+typedef struct {
+    uint32_t minorCount;                /* Minor GCs run */
+    uint32_t fullCount;                 /* Full GC cycles finished */
+    uint32_t pauseCount;                /* One per minor GC, full GC or incremental slice */
+    uint32_t lastPauseUs;
+    uint32_t maxPauseUs;
+    uint64_t totalPauseUs;
+    uint32_t lastFreedBytes;            /* Object bytes freed by the last minor GC or full cycle */
+    uint32_t lastFreedObjects;
+    uint64_t totalFreedBytes;
+    uint64_t totalFreedObjects;
+    uint64_t totalAllocatedBytes;
+    uint32_t allocationRate;            /* Bytes per second allocated between the last two collections */
+    uint32_t liveBytes;                 /* Old object bytes, survivors of the last full GC and promoted since */
+    uint32_t usedBytes;                 /* liveBytes plus the bytes allocated since the last collection */
+    uint32_t gcThreshold;
+    uint32_t heapBlocks;                /* Blocks currently allocated through Flint::malloc */
+} GcStats;
+
+/*
+ * Locks, in the order they must be taken. A thread holding one of them may only take the ones below it:
+ *   flintLock   - class loaders, classes, constant strings, jar indexes and handles, constant pool resolution,
+ *                 lazy method loading and inline caches. GC takes it first so loaders stay put while statics are scanned
+ *   heapLock    - object lists, shutdown hooks, heap accounting and the slab heap
+ *   execLock    - execution list
+ *   allocLock   - new object list of one FExec, taken by its own thread to add objects and by the GC to collect them
+ *   utf8Lock    - UTF-8 pool
+ *   monitorLock - entry queues and wait sets of inflated monitors
+ * Flint::malloc may run the GC, so nothing is allocated while holding heapLock, execLock, allocLock, utf8Lock or monitorLock.
+ * All locks are recursive.
+ */
 class Flint {
 private:
     FMutex flintLock;
+    FMutex heapLock;
+    FMutex execLock;
+    FMutex utf8Lock;
+    FMutex monitorLock;
     FDbg *dbg;
     const char *cwd;
     const char *program;
@@ -28,18 +72,42 @@ private:
     FDict<JClassDictNode> classes;
     FDict<Utf8DictNode> utf8s;
     FDict<JStringDictNode> constStr;
+    FDict<ZipIndex> zipIndexes;
+    FDict<FileDictNode> files;
     FList<FExec> execs;
     FList<JObject> objs;
     FList<JObject> globalObjs;
+    FList<JObject> youngObjs;           /* Young objects of finished threads, and all of them during a minor GC */
     FList<Hook> shutdownHook;
+    FHeap heap;
 
     JClass *classOfClass;
     JClass *classOfObject;
     JClass *classOfCloneable;
     JClass *classOfSerializable;
 
+    uint16_t interfaceIdCount;          /* Ids given to interfaces for the interface sets of the class loaders */
     uint32_t heapCount;
-    uint32_t objectCountToGc;
+    uint32_t allocatedBytes;            /* Bytes allocated since the last GC */
+    uint32_t gcThreshold;               /* Old space growth that triggers the next full GC */
+    uint32_t liveBytes;                 /* Object bytes that survived the last full GC */
+    uint32_t promotedBytes;             /* Bytes added to objs since the last full GC */
+    uint32_t rememberedCount;           /* Greater than GC_REMEMBERED_SET_SIZE once the set has overflowed */
+    uint16_t markStackTop;
+    bool markStackOverflow;
+    bool minorMarking;                  /* Only young objects are marked */
+    GcPhase gcPhase;                    /* Phase of the full GC cycle in progress */
+    JObject *sweepCursor;               /* Next object of objs to sweep */
+    uint32_t nextGcStep;                /* allocatedBytes that runs the next incremental slice */
+    uint32_t sweepTotalBytes;
+    uint32_t sweepSurvivedBytes;
+    uint32_t sweepFreedObjects;
+    GcStats gcStats;                    /* Counters only, the heap figures are filled in by getGcStats */
+    int64_t lastCollectionTime;         /* Nanoseconds, end of the last minor GC or full cycle */
+    uint64_t lastCollectionAllocated;   /* gcStats.totalAllocatedBytes at that time */
+    bool heapDumped;                    /* The heap was dumped on an OutOfMemoryError since the last reset */
+    JObject *markStack[GC_MARK_STACK_SIZE];
+    JObject *remembered[GC_REMEMBERED_SET_SIZE];
     void *heapStart;
     void *headEnd;
 
@@ -49,6 +117,17 @@ private:
     void updateHeapRegion(void *p);
     void resetHeapRegion(void);
     bool isHeapPointer(void *p);
+    void *heapAlloc(uint32_t size);
+    void *allocObject(FExec *ctx, uint32_t size);
+    void *refillTlab(FExec *ctx, uint8_t sizeClass);
+    void releaseTlab(FExec *exec);
+    void addObject(FExec *ctx, JObject *obj);
+    void takeNewObjects(FExec *exec);
+    void detachObject(JObject *obj);
+    bool isYoung(JObject *obj);
+    void remember(JObject *obj);
+    void forget(JObject *obj);
+    void collectIfNeeded(void);
 public:
     Flint(void);
     void *malloc(FExec *ctx, uint32_t size);
@@ -58,6 +137,10 @@ public:
     void lock(void);
     void unlock(void);
 
+    bool monitorEnter(FExec *ctx, LockWord *lock);
+    void monitorExit(FExec *ctx, LockWord *lock);
+    void freeMonitor(LockWord *lock);
+
     FDbg *getDebugger(void);
     void setDebugger(FDbg *dbg);
 public:
@@ -82,6 +165,8 @@ public:
     int16_t resolvePath(const char *path, uint16_t length, char *buff, uint16_t buffSize);
 
     const char *getUtf8(FExec *ctx, const char *utf8, uint16_t length = 0xFFFF);
+    ZipIndex *getZipIndex(FileReader *reader);
+    FlintAPI::IO::FileHandle getFileHandle(const char *filePath);
     ClassLoader *findLoader(FExec *ctx, const char *clsName, uint16_t length = 0xFFFF);
     JClass *findClass(FExec *ctx, const char *clsName, uint16_t length = 0xFFFF, bool verify = false);
     JClass *findClassOfArray(FExec *ctx, const char *clsName, uint8_t dimensions);
@@ -90,15 +175,18 @@ public:
     JClass *getClassOfObject(FExec *ctx);
     JClass *getClassOfCloneable(FExec *ctx);
     JClass *getClassOfSerializable(FExec *ctx);
+    ClassLoader *getFieldsLoader(JObject *obj);
     MethodInfo *findMethod(FExec *ctx, JClass *cls, ConstNameAndType *nameAndType);
     JString *getConstString(FExec *ctx, const char *utf8);
     JString *getConstString(FExec *ctx, JString *str);
 
     bool isInstanceof(FExec *ctx, JObject *obj, JClass *type);
     bool isAssignableFrom(FExec *ctx, JClass *fromType, JClass *toType);
+    uint16_t newInterfaceId(void);
 
     FExec *newExecution(FExec *ctx, JThread *owner = NULL);
     void freeExecution(FExec *exec);
+    void interruptThread(JThread *thread);
 
     JObject *newObject(FExec *ctx, JClass *type);
     JObject *newArray(FExec *ctx, JClass *type, uint32_t count);
@@ -110,7 +198,11 @@ public:
     void makeToGlobal(JObject *obj);
     void clearProtLv2(JObject *obj);
     bool isObject(void *p);
+    void writeBarrier(FExec *ctx, JObject *holder, JObject *value);
+    void staticWriteBarrier(ClassLoader *loader, JObject *value);
     void gc(void);
+    void getGcStats(GcStats *stats);
+    bool dumpHeap(const char *path);
 
     bool start(MethodInfo *method, uint32_t argc = 0, ...);
     bool startToMain(uint32_t argc = 0, ...);
@@ -122,6 +214,7 @@ public:
     void freeObject(JObject *obj);
     void clearAllStaticFields(void);
     void freeAllExecution(void);
+    void freeAllFileHandle(void);
     void freeAll(void);
     void reset(void);
 
@@ -140,15 +233,41 @@ private:
     void freeAllObject(void);
     void freeAllClassLoader(void);
     void freeAllConstUtf8(void);
-    void clearMarkRecursion(JObject *obj);
-    void markObjectRecursion(JObject *obj);
-    void clearProtLv2Recursion(JObject *obj);
+    void freeAllZipIndex(void);
+    template <typename T>
+    void forEachReference(JObject *obj, T func);
+    template <typename T>
+    void forEachObject(T func);
+    void pushMark(JObject *obj);
+    void shade(JObject *obj);
+    void drainMarkStack(void);
+    void markObject(JObject *obj);
+    void finishMark(void);
+    void clearMark(JObject *obj);
+    void markChildren(JObject *obj);
+    void markStaticFields(ClassLoader *loader);
+    void markExecution(FExec *exec, FList<JObject> *space);
+    void minorGc(void);
+    void releaseProtLv2(JObject *obj);
+    void startGcCycle(void);
+    bool markSlice(int64_t deadline);
+    void remark(void);
+    bool sweepSlice(int64_t deadline);
+    void finishGcCycle(void);
+    bool gcSlice(int64_t deadline);
+    void gcStep(bool start);
+    void updateGcThreshold(uint32_t survivedBytes, uint32_t totalBytes);
+    void recordPause(int64_t startTime);
+    void recordCollection(uint32_t freedBytes, uint32_t freedObjects);
+    void dumpHeapOnOom(void);
+    Monitor *inflateMonitor(FExec *ctx, LockWord *lock);
 private:
+    Utf8DictNode *findArrayClassName(uint32_t hash, const char *clsName, uint8_t dimensions);
     const char *getArrayClassName(FExec *ctx, const char *clsName, uint8_t dimensions);
     JClass *newClass(FExec *ctx, const char *clsName, uint16_t length = 0xFFFF, uint8_t flag = 0x00);
     JClass *newClassOfArray(FExec *ctx, const char *clsName, uint8_t dimensions);
     JClass *newClassOfClass(FExec *ctx);
-    bool isAssignableFromInterface(FExec *ctx, JClass *fromType, JClass *toIfType);
+    JClass *getElementType(FExec *ctx, JClass *arrayType);
 private:
     Flint(const Flint &) = delete;
     void operator=(const Flint &) = delete;
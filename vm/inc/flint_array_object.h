@@ -16,8 +16,6 @@ private:
     JArray(void) = delete;
     JArray(const JArray &) = delete;
     void operator=(const JArray &) = delete;
-
-    bool initFields(class FExec *ctx, class ClassLoader *loader) = delete;
 };
 
 class JInt8Array : public JArray {
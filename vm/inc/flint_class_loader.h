@@ -31,6 +31,11 @@ typedef enum {
     INITIALIZED = 0x02,
 } StaticInitStatus;
 
+typedef struct {
+    class ClassLoader *loader;
+    MethodInfo **methods;
+} ITable;
+
 class ClassLoader : public DictNode {
 private:
     uint8_t loaderFlags;
@@ -48,11 +53,18 @@ private:
     uint16_t methodsCount;
     uint16_t nestHost;
     uint16_t nestMembersCount;
+    uint16_t vtableLength;
+    uint16_t itablesCount;
+    uint16_t instanceSlotCount;
+    uint16_t instanceObjCount;
+    uint16_t superDepth;            /* Number of super classes, the index of this class in superDisplay */
+    uint16_t interfaceId;           /* Bit of this interface in interfaceSet, 0 until a linked class implements it */
+    uint16_t interfaceSetWords;
 
     uint32_t hash;
 public:
-    uint32_t monitorOwnId;
-    uint32_t monitorCount;
+    LockWord monitor;
+    bool youngStatics;              /* A static field was set to a young object since the last GC */
 private:
     class Flint * const flint;
     ConstPool *poolTable;
@@ -62,6 +74,12 @@ private:
     uint16_t *nestMembers;
     FieldsData *staticFields;
     const char *filePath;
+    MethodInfo **vtable;
+    ITable *itables;
+    ClassLoader *superLoader;
+    uint32_t *instanceRefMap;   /* One bit per instance slot, set for reference fields */
+    ClassLoader **superDisplay; /* java/lang/Object first, this class last */
+    uint32_t *interfaceSet;     /* One bit per interfaceId, set for every interface this class implements */
 public:
     uint32_t getHashKey(void) const override;
     int32_t compareKey(const char *key, uint16_t length) const override;
@@ -74,6 +92,7 @@ public:
     double getConstDouble(uint16_t poolIndex) const;
     const char *getConstUtf8(uint16_t poolIndex) const;
     const char *getConstClassName(uint16_t poolIndex) const;
+    const char *getConstMemberDesc(uint16_t poolIndex) const;
 
     ConstNameAndType *getConstNameAndType(FExec *ctx, uint16_t poolIndex);
     ConstField *getConstField(FExec *ctx, uint16_t poolIndex);
@@ -82,6 +101,7 @@ public:
 
     JString *getConstString(FExec *ctx, uint16_t poolIndex);
     JClass *getConstClass(FExec *ctx, uint16_t poolIndex);
+    JObject *getConstObject(uint16_t poolIndex) const;
 
     ClassAccessFlag getAccessFlag(void) const;
 
@@ -98,6 +118,8 @@ public:
 
     uint16_t getFieldsCount(void) const;
     FieldInfo *getFieldInfo(uint16_t fieldIndex) const;
+    FieldInfo *getFieldInfo(ConstNameAndType *nameAndType, bool isStatic) const;
+    FieldInfo *getFieldInfo(const char *name, bool isStatic) const;
 
     uint16_t getMethodsCount(void) const;
     MethodInfo *getMethodInfo(FExec *ctx, uint16_t methodIndex);
@@ -105,6 +127,8 @@ public:
     MethodInfo *getMethodInfo(FExec *ctx, const char *name, const char *desc);
     MethodInfo *getMainMethodInfo(FExec *ctx);
     MethodInfo *getStaticCtor(FExec *ctx);
+    MethodInfo *getVirtualMethod(FExec *ctx, MethodInfo *method);
+    MethodInfo *getVtableMethod(uint16_t index) const;
 
     bool hasStaticField(void) const;
     bool hasStaticCtor(void) const;
@@ -114,6 +138,15 @@ public:
     uint16_t getNestMembersCount(void) const;
     JClass *getNestMember(FExec *ctx, uint16_t index);
 
+    bool isSubclassOf(FExec *ctx, ClassLoader *loader);
+
+    bool initLayout(FExec *ctx);
+    uint32_t getInstanceSize(void) const;
+    uint16_t hasInstanceObjField(void) const;
+    const uint32_t *getInstanceRefMap(void) const;
+    FieldInfo *getInstanceField(ConstNameAndType *nameAndType) const;
+    FieldInfo *getInstanceField(const char *name) const;
+
     uint16_t hasStaticObjField(void) const;
     FieldValue *getStaticField(FExec *ctx, ConstField *field) const;
     FieldValue *getStaticField(FExec *ctx, const char *name) const;
@@ -123,13 +156,22 @@ public:
     void staticInitialized(void);
     bool initStaticFields(FExec *ctx);
     void clearStaticFields(void);
+    void clearConstFieldValues(void);
 private:
     ClassLoader(Flint *flint);
     ClassLoader(const ClassLoader &) = delete;
     void operator=(const ClassLoader &) = delete;
 
     bool load(FileReader *reader);
-    CodeAttribute *readAttributeCode(FileReader *reader);
+    CodeAttribute *readAttributeCode(FileReader *reader, MethodInfo *method);
+    void freeAttributeCode(CodeAttribute *codeAttr);
+
+    bool link(FExec *ctx);
+    bool buildVtable(FExec *ctx, ClassLoader *superLoader);
+    bool buildItables(FExec *ctx, ClassLoader *superLoader);
+    bool buildTypeDisplay(FExec *ctx, ClassLoader *superLoader);
+    MethodInfo *findVtableMethod(MethodInfo *method) const;
+    void freeTables(void);
 public:
     static ClassLoader *load(Flint *flint, FExec *ctx, const char *clsName, uint16_t length = 0xFFFF);
 
@@ -29,4 +29,6 @@ uint16_t GetArgNameLength(const char *desc);
 uint8_t GetArgCount(const char *desc);
 uint8_t GetArgSlotCount(const char *desc);
 
+uint32_t GetInstructionLength(const uint8_t *code, uint32_t pc);
+
 #endif /* __FLINT_COMMON_H */
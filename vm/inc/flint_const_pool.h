@@ -58,13 +58,15 @@ public:
     ConstNameAndType *nameAndType;
 private:
     uint32_t fieldIndex;
+    class FieldValue *staticValue;  /* Set once the owner class is initialized, used by the quickened getstatic/putstatic */
 private:
     ConstField(const char *className, ConstNameAndType *nameAndType);
     ConstField(const ConstField &) = delete;
     void operator=(const ConstField &) = delete;
 
+    friend class FExec;
     friend class ClassLoader;
-    friend class FieldsData;
+    friend class JObject;
 };
 
 class ConstMethod {
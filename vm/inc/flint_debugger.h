@@ -56,6 +56,8 @@ typedef enum : uint8_t {
     DBG_CMD_READ_DIR,
     DBG_CMD_CREATE_DIR,
     DBG_CMD_CLOSE_DIR,
+    DBG_CMD_READ_GC_STATS,
+    DBG_CMD_DUMP_HEAP,
 } DbgCmd;
 
 typedef enum : uint8_t {
@@ -167,6 +169,8 @@ private:
     void readDirRequest(void);
     void closeDirRequest(void);
     void readConsoleBufferRequest(void);
+    void readGcStatsRequest(void);
+    void dumpHeapRequest(const char *path);
 public:
     bool receivedDataHandler(uint8_t *data, uint32_t length);
     bool exceptionIsEnabled(void);
@@ -16,15 +16,89 @@
     #warning "FILE_NAME_BUFF_SIZE is not defined. Default value will be used"
 #endif /* FILE_NAME_BUFF_SIZE */
 
+#ifndef FILE_READ_BUFFER_SIZE
+    #define FILE_READ_BUFFER_SIZE       512
+    #warning "FILE_READ_BUFFER_SIZE is not defined. Default value will be used"
+#endif /* FILE_READ_BUFFER_SIZE */
+
 #ifndef DEFAULT_STACK_SIZE
     #define DEFAULT_STACK_SIZE          MEGA_BYTE(1)
     #warning "DEFAULT_STACK_SIZE is not defined. Default value will be used"
 #endif /* DEFAULT_STACK_SIZE */
 
-#ifndef OBJECT_COUNT_TO_GC
-    #define OBJECT_COUNT_TO_GC          10000
-    #warning "OBJECT_COUNT_TO_GC is not defined. Default value will be used"
-#endif /* OBJECT_COUNT_TO_GC */
+#ifndef HEAP_SLAB_REGION_SIZE
+    #define HEAP_SLAB_REGION_SIZE       KILO_BYTE(128)
+    #warning "HEAP_SLAB_REGION_SIZE is not defined. Default value will be used"
+#endif /* HEAP_SLAB_REGION_SIZE */
+
+#ifndef TLAB_BLOCK_COUNT
+    #define TLAB_BLOCK_COUNT            16
+    #warning "TLAB_BLOCK_COUNT is not defined. Default value will be used"
+#endif /* TLAB_BLOCK_COUNT */
+
+#ifndef GC_NURSERY_SIZE
+    #define GC_NURSERY_SIZE             KILO_BYTE(64)
+    #warning "GC_NURSERY_SIZE is not defined. Default value will be used"
+#endif /* GC_NURSERY_SIZE */
+
+#ifndef GC_REMEMBERED_SET_SIZE
+    #define GC_REMEMBERED_SET_SIZE      256
+    #warning "GC_REMEMBERED_SET_SIZE is not defined. Default value will be used"
+#endif /* GC_REMEMBERED_SET_SIZE */
+
+#ifndef GC_PAUSE_BUDGET_US
+    #define GC_PAUSE_BUDGET_US          0
+    #warning "GC_PAUSE_BUDGET_US is not defined. Default value will be used"
+#endif /* GC_PAUSE_BUDGET_US */
+
+#ifndef GC_STEP_SIZE
+    #define GC_STEP_SIZE                KILO_BYTE(16)
+    #warning "GC_STEP_SIZE is not defined. Default value will be used"
+#endif /* GC_STEP_SIZE */
+
+#ifndef GC_HEAP_BUDGET
+    #define GC_HEAP_BUDGET              MEGA_BYTE(2)
+    #warning "GC_HEAP_BUDGET is not defined. Default value will be used"
+#endif /* GC_HEAP_BUDGET */
+
+#ifndef GC_MIN_THRESHOLD
+    #define GC_MIN_THRESHOLD            KILO_BYTE(64)
+    #warning "GC_MIN_THRESHOLD is not defined. Default value will be used"
+#endif /* GC_MIN_THRESHOLD */
+
+#ifndef GC_HEAP_GROWTH_PERCENT
+    #define GC_HEAP_GROWTH_PERCENT      100
+    #warning "GC_HEAP_GROWTH_PERCENT is not defined. Default value will be used"
+#endif /* GC_HEAP_GROWTH_PERCENT */
+
+#ifndef GC_MARK_STACK_SIZE
+    #define GC_MARK_STACK_SIZE          128
+    #warning "GC_MARK_STACK_SIZE is not defined. Default value will be used"
+#endif /* GC_MARK_STACK_SIZE */
+
+#ifndef HEAP_DUMP_BUFFER_SIZE
+    #define HEAP_DUMP_BUFFER_SIZE       512
+    #warning "HEAP_DUMP_BUFFER_SIZE is not defined. Default value will be used"
+#endif /* HEAP_DUMP_BUFFER_SIZE */
+
+#ifndef HEAP_DUMP_ON_OOM
+    #define HEAP_DUMP_ON_OOM            0
+    #warning "HEAP_DUMP_ON_OOM is not defined. Default value will be used"
+#endif /* HEAP_DUMP_ON_OOM */
+
+#ifndef HEAP_DUMP_FILE_NAME
+    #define HEAP_DUMP_FILE_NAME         "heap.fhpd"
+    #warning "HEAP_DUMP_FILE_NAME is not defined. Default value will be used"
+#endif /* HEAP_DUMP_FILE_NAME */
+
+#ifndef INLINE_CACHE_SIZE
+    #define INLINE_CACHE_SIZE           2
+    #warning "INLINE_CACHE_SIZE is not defined. Default value will be used"
+#endif /* INLINE_CACHE_SIZE */
+
+#if(INLINE_CACHE_SIZE < 1 || INLINE_CACHE_SIZE > 4)
+    #error "INLINE_CACHE_SIZE must be in range 1 to 4"
+#endif
 
 #ifndef MAX_OF_BREAK_POINT
     #define MAX_OF_BREAK_POINT          20
@@ -6,6 +6,8 @@
 #include "flint_common.h"
 #include "flint_debugger.h"
 #include "flint_list.h"
+#include "flint_heap.h"
+#include "flint_mutex.h"
 #include "flint_const_pool.h"
 #include "flint_method_info.h"
 #include "flint_java_thread.h"
@@ -29,6 +31,11 @@ private:
     JThread *ownerThread;
     JThrowable *excp;
     JObject *currentWaiting;
+    FExec *monitorNext;             /* Link in a monitor's entry queue or wait set */
+    FMutex allocLock;               /* Guards newObjs against the GC */
+    FList<JObject> newObjs;         /* Objects allocated by this thread since the last GC */
+    void *tlab[HEAP_SIZE_CLASS_COUNT]; /* Slab blocks reserved for this thread, by size class */
+    JObject *lastRemembered;        /* Last object this thread added to the remembered set */
     int32_t stack[];
 
     void stackPushInt32(int32_t value);
@@ -62,8 +69,9 @@ private:
     void invoke(MethodInfo *methodInfo, uint8_t argc);
     void invokeStatic(ConstMethod *constMethod);
     void invokeSpecial(ConstMethod *constMethod);
-    void invokeVirtual(ConstMethod *constMethod);
-    void invokeInterface(ConstInterfaceMethod *interfaceMethod, uint8_t argc);
+    MethodInfo *findVirtualMethod(ConstMethod *constMethod, JObject *obj, InlineCache *cache);
+    void invokeVirtual(ConstMethod *constMethod, InlineCache *cache);
+    void invokeInterface(ConstInterfaceMethod *interfaceMethod, uint8_t argc, InlineCache *cache);
     void invokeStaticCtor(ClassLoader *cls);
 
     void exec(bool initOpcodeLabels);
@@ -111,25 +119,26 @@ public:
     jobjectArray newObjectArray(jclass type, uint32_t count) __attribute__((used));
 
     jfieldId getFieldId(jobject obj, const char *name) __attribute__((used));
-    jbool getBoolField(jfieldId fid) __attribute__((used));
-    jbyte getByteField(jfieldId fid) __attribute__((used));
-    jchar getCharField(jfieldId fid) __attribute__((used));
-    jshort getShortField(jfieldId fid) __attribute__((used));
-    jint getIntField(jfieldId fid) __attribute__((used));
-    jfloat getFloatField(jfieldId fid) __attribute__((used));
-    jlong getLongField(jfieldId fid) __attribute__((used));
-    jdouble getDoubleField(jfieldId fid) __attribute__((used));
-    jobject getObjField(jfieldId fid) __attribute__((used));
-
-    jvoid setBoolField(jfieldId fid, jbool val) __attribute__((used));
-    jvoid setByteField(jfieldId fid, jbyte val) __attribute__((used));
-    jvoid setCharField(jfieldId fid, jchar val) __attribute__((used));
-    jvoid setShortField(jfieldId fid, jshort val) __attribute__((used));
-    jvoid setIntField(jfieldId fid, jint val) __attribute__((used));
-    jvoid setFloatField(jfieldId fid, jfloat val) __attribute__((used));
-    jvoid setLongField(jfieldId fid, jlong val) __attribute__((used));
-    jvoid setDoubleField(jfieldId fid, jdouble val) __attribute__((used));
-    jvoid setObjField(jfieldId fid, jobject obj) __attribute__((used));
+    jbool getBoolField(jobject obj, jfieldId fid) __attribute__((used));
+    jbyte getByteField(jobject obj, jfieldId fid) __attribute__((used));
+    jchar getCharField(jobject obj, jfieldId fid) __attribute__((used));
+    jshort getShortField(jobject obj, jfieldId fid) __attribute__((used));
+    jint getIntField(jobject obj, jfieldId fid) __attribute__((used));
+    jfloat getFloatField(jobject obj, jfieldId fid) __attribute__((used));
+    jlong getLongField(jobject obj, jfieldId fid) __attribute__((used));
+    jdouble getDoubleField(jobject obj, jfieldId fid) __attribute__((used));
+    jobject getObjField(jobject obj, jfieldId fid) __attribute__((used));
+
+    jvoid setBoolField(jobject obj, jfieldId fid, jbool val) __attribute__((used));
+    jvoid setByteField(jobject obj, jfieldId fid, jbyte val) __attribute__((used));
+    jvoid setCharField(jobject obj, jfieldId fid, jchar val) __attribute__((used));
+    jvoid setShortField(jobject obj, jfieldId fid, jshort val) __attribute__((used));
+    jvoid setIntField(jobject obj, jfieldId fid, jint val) __attribute__((used));
+    jvoid setFloatField(jobject obj, jfieldId fid, jfloat val) __attribute__((used));
+    jvoid setLongField(jobject obj, jfieldId fid, jlong val) __attribute__((used));
+    jvoid setDoubleField(jobject obj, jfieldId fid, jdouble val) __attribute__((used));
+    jvoid setObjField(jobject obj, jfieldId fid, jobject val) __attribute__((used));
+    jvoid writeBarrier(jobject obj, jobject val) __attribute__((used));
 
     jmethodId getMethodId(jclass cls, const char *name, const char *sig) __attribute__((used));
     jmethodId getConstructorId(jclass cls, const char *sig) __attribute__((used));
@@ -154,6 +163,7 @@ private:
 
     friend class Flint;
     friend class FDbg;
+    friend class Monitor;
     friend class FNIEnv;
 
     friend jobject NativeMethod_Invoke0(FNIEnv *, jobject, jobject, jobjectArray);
@@ -21,6 +21,9 @@ typedef enum : uint16_t {
 class FieldInfo {
 public:
     const FieldAccessFlag accessFlag;
+private:
+    uint16_t slot;
+public:
     union {
         struct {
             const char * const name;
@@ -29,6 +32,8 @@ public:
         };
         ConstNameAndType nameAndType;
     };
+
+    uint16_t getSlot(void) const;
 private:
     FieldInfo(FieldAccessFlag accessFlag, const char *name, const char *desc);
 
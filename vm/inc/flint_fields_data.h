@@ -7,10 +7,8 @@
 
 class FieldValue {
 private:
-    const FieldInfo * const fieldInfo;
     uint32_t value;
 public:
-    const FieldInfo *getFieldInfo(void) const;
     int32_t getInt32(void) const;
     class JObject *getObj(void) const;
     int64_t getInt64(void) const;
@@ -18,11 +16,8 @@ public:
     void setObj(class JObject *obj);
     void setInt64(int64_t val);
 private:
-    FieldValue(const FieldInfo *fieldInfo);
     FieldValue(const FieldValue &) = delete;
     void operator=(const FieldValue &) = delete;
-
-    friend class FieldsData;
 };
 
 class FieldsData {
@@ -36,21 +31,14 @@ public:
 
     uint16_t hasObjField(void) const;
 
-    FieldValue *getField(ConstField *field) const;
-    FieldValue *getField(const char *name) const;
     FieldValue *getFieldByIndex(uint32_t index) const;
 
-    bool init(class Flint *flint, class FExec *ctx, class ClassLoader *loader, bool isStatic);
+    bool init(class Flint *flint, class FExec *ctx, class ClassLoader *loader);
 
     void destroy(class Flint *flint);
-private:
-    bool initStatic(class Flint *flint, class FExec *ctx, class ClassLoader *loader);
-    bool initNonStatic(class Flint *flint, class FExec *ctx, class ClassLoader *loader);
 private:
     FieldsData(const FieldsData &) = delete;
     void operator=(const FieldsData &) = delete;
-
-    friend class Flint;
 };
 
 #endif /* __FLINT_FIELDS_DATA_H */
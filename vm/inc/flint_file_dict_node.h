@@ -0,0 +1,28 @@
+
+#ifndef __FLINT_FILE_DICT_NODE_H
+#define __FLINT_FILE_DICT_NODE_H
+
+#include "flint_dictionary.h"
+#include "flint_system_api.h"
+
+class FileDictNode : public DictNode {
+private:
+    uint32_t hash;
+    FlintAPI::IO::FileHandle handle;
+    char path[];
+public:
+    uint32_t getHashKey(void) const override;
+    int32_t compareKey(const char *key, uint16_t length) const override;
+    int32_t compareKey(DictNode *other) const override;
+
+    const char *getPath(void) const;
+    FlintAPI::IO::FileHandle getHandle(void) const;
+private:
+    FileDictNode(const char *path, FlintAPI::IO::FileHandle handle);
+    FileDictNode(const FileDictNode &) = delete;
+    void operator=(const FileDictNode &) = delete;
+
+    friend class Flint;
+};
+
+#endif /* __FLINT_FILE_DICT_NODE_H */
@@ -6,17 +6,28 @@
 
 class FileReader {
 protected:
+    class Flint *flint;
     FlintAPI::IO::FileHandle handle;
     class FExec *ctx;
     const char *filePath;
+private:
+    uint32_t position;
+    uint32_t buffOffset;
+    uint32_t buffLength;
+    uint8_t buff[FILE_READ_BUFFER_SIZE];
+
+    bool fill(void);
+protected:
+    virtual int32_t fetch(uint32_t offset, uint8_t *dst, uint32_t size);
+    void discardBuffer(void);
 public:
     FileReader(void);
-    FileReader(class FExec *ctx, const char *filePath);
+    FileReader(class Flint *flint, class FExec *ctx, const char *filePath);
 
     bool open(void);
-    bool close(void);
+    virtual bool close(void);
 
-    int32_t read(void *buff, uint32_t size);
+    int32_t read(void *data, uint32_t size);
 
     bool readUInt8(uint8_t &value);
     bool readUInt16(uint16_t &value);
@@ -33,6 +44,7 @@ public:
     bool seek(int32_t offset);
     bool offset(int32_t offset);
     uint32_t size(void);
+    virtual bool isCompressed(void) const;
 
     const char *getFilePath(void);
     class FExec *getContext(void);
@@ -0,0 +1,72 @@
+
+#ifndef __FLINT_HEAP_H
+#define __FLINT_HEAP_H
+
+#include "flint_std.h"
+#include "flint_default_conf.h"
+
+#define HEAP_PAGE_SIZE              2048
+#define HEAP_MAX_SMALL_SIZE         256
+#define HEAP_SIZE_CLASS_COUNT       13
+#define HEAP_PAGE_COUNT             (HEAP_SLAB_REGION_SIZE / HEAP_PAGE_SIZE)
+#define HEAP_LARGE_CLASS            0xFF
+
+class HeapPage {
+private:
+    HeapPage *prev;
+    HeapPage *next;
+    void *freeList;                 /* Free blocks of this page, linked through their first word */
+    uint16_t used;                  /* Blocks in use, or the number of pages of a large block */
+    uint8_t sizeClass;
+    uint8_t reserved;
+
+    HeapPage(const HeapPage &) = delete;
+    void operator=(const HeapPage &) = delete;
+
+    friend class FHeap;
+};
+
+/*
+ * Small blocks (up to HEAP_MAX_SMALL_SIZE bytes) are served from pages of one size class carved out of a
+ * single region of HEAP_SLAB_REGION_SIZE bytes, reserved from the system on first use.
+ * Larger blocks, and small ones once the region is full, are left to the system allocator.
+ * Free pages are always reused lowest address first, so live pages pack at the bottom of the region and
+ * the free ones stay contiguous. A large block the system can no longer place is served from such a run.
+ * Not thread safe, Flint calls it under heapLock
+ */
+class FHeap {
+private:
+    uint8_t *regionStart;
+    uint8_t *regionTop;             /* Pages below this have been handed out at least once */
+    HeapPage *partialPages[HEAP_SIZE_CLASS_COUNT];
+    bool regionFailed;
+    uint32_t pageMap[HEAP_PAGE_COUNT / 32 + 1];    /* One bit per page of the region, set while it is in use */
+
+    FHeap(const FHeap &) = delete;
+    void operator=(const FHeap &) = delete;
+
+    bool initRegion(void);
+    int32_t findFreePages(uint32_t count) const;
+    void setPages(uint32_t index, uint32_t count, bool inUse);
+    HeapPage *takePages(uint32_t count);
+    HeapPage *newPage(uint8_t sizeClass);
+    HeapPage *getPage(const void *p) const;
+
+    static void linkPage(HeapPage **list, HeapPage *page);
+    static void unlinkPage(HeapPage **list, HeapPage *page);
+public:
+    FHeap(void);
+
+    void *alloc(uint32_t size);
+    void *allocBatch(uint8_t sizeClass, uint32_t maxCount, uint32_t *count);
+    void *allocLarge(uint32_t size);
+    bool free(void *p);
+
+    bool contains(const void *p) const;
+    uint32_t getBlockSize(const void *p) const;
+
+    static int32_t getSizeClass(uint32_t size);
+    static uint32_t getClassSize(uint8_t sizeClass);
+};
+
+#endif /* __FLINT_HEAP_H */
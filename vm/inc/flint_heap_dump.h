@@ -0,0 +1,56 @@
+
+#ifndef __FLINT_HEAP_DUMP_H
+#define __FLINT_HEAP_DUMP_H
+
+#include "flint_system_api.h"
+
+/*
+ * Heap dump file format. All values are little endian, an object id is its address and 0 is null.
+ *
+ *   Header: "FHPD", u16 version, u16 id size (4)
+ *   Then records, each starts with a u8 tag:
+ *     HEAP_DUMP_CLASS          u32 class id, u16 name length, name
+ *     HEAP_DUMP_OBJECT         u32 id, u32 class id (0 for a class object), u32 size in bytes, u32 references... 0
+ *     HEAP_DUMP_ROOT_GLOBAL    u32 id
+ *     HEAP_DUMP_ROOT_STATIC    u16 class name length, class name, u32 references... 0
+ *     HEAP_DUMP_ROOT_THREAD    u32 thread id, u32 id
+ *     HEAP_DUMP_END
+ *
+ * A class record is written for every class object, before or after the objects that refer to it
+ */
+
+#define HEAP_DUMP_VERSION           1
+
+typedef enum : uint8_t {
+    HEAP_DUMP_CLASS = 0x01,
+    HEAP_DUMP_OBJECT = 0x02,
+    HEAP_DUMP_ROOT_GLOBAL = 0x03,
+    HEAP_DUMP_ROOT_STATIC = 0x04,
+    HEAP_DUMP_ROOT_THREAD = 0x05,
+    HEAP_DUMP_END = 0xFF,
+} HeapDumpTag;
+
+class HeapDumpWriter {
+private:
+    FlintAPI::IO::FileHandle handle;
+    uint32_t buffLength;
+    bool error;
+    uint8_t buff[HEAP_DUMP_BUFFER_SIZE];
+
+    void flush(void);
+public:
+    HeapDumpWriter(void);
+
+    bool open(const char *path);
+    bool close(void);
+
+    void write(const void *data, uint32_t size);
+    void writeUInt8(uint8_t value);
+    void writeUInt16(uint16_t value);
+    void writeUInt32(uint32_t value);
+private:
+    HeapDumpWriter(const HeapDumpWriter &) = delete;
+    void operator=(const HeapDumpWriter &) = delete;
+};
+
+#endif /* __FLINT_HEAP_DUMP_H */
@@ -0,0 +1,61 @@
+
+#ifndef __FLINT_INFLATER_H
+#define __FLINT_INFLATER_H
+
+#include "flint_system_api.h"
+
+#define INFLATE_FAST_BITS           9
+#define INFLATE_MAX_WINDOW_SIZE     32768
+
+typedef struct {
+    uint16_t fast[1 << INFLATE_FAST_BITS];  /* (length << 9) | symbol, indexed by the next bits of the input */
+    uint16_t firstCode[16];
+    uint16_t firstSymbol[16];
+    uint32_t maxCode[17];                   /* First code after each length, left aligned to 16 bits */
+    uint16_t symbols[288];
+} InflateTable;
+
+class Inflater {
+private:
+    FlintAPI::IO::FileHandle handle;
+    uint32_t srcOffset;
+    uint32_t srcSize;
+    uint32_t srcPosition;
+    uint32_t outPosition;
+    uint32_t bitBuff;
+    uint32_t bitCount;
+    uint32_t padding;
+    uint32_t storedLength;
+    uint16_t copyLength;
+    uint16_t copyDistance;
+    uint16_t inPosition;
+    uint16_t inLength;
+    uint8_t state;
+    bool lastBlock;
+    uint32_t windowMask;
+    InflateTable lenTable;
+    InflateTable distTable;
+    uint8_t inBuff[FILE_READ_BUFFER_SIZE];
+    uint8_t window[];
+public:
+    static Inflater *create(class Flint *flint, class FExec *ctx, FlintAPI::IO::FileHandle handle, uint32_t offset, uint32_t compressedSize, uint32_t size);
+
+    int32_t read(uint32_t offset, uint8_t *dst, uint32_t size);
+private:
+    Inflater(FlintAPI::IO::FileHandle handle, uint32_t offset, uint32_t compressedSize, uint32_t windowSize);
+    Inflater(const Inflater &) = delete;
+    void operator=(const Inflater &) = delete;
+
+    void reset(void);
+    uint8_t nextByte(void);
+    void fillBits(void);
+    uint32_t getBits(uint32_t count);
+    int32_t decode(const InflateTable *table);
+    bool readBlockHeader(void);
+    bool readDynamicTables(void);
+    int32_t inflate(uint8_t *dst, uint32_t size);
+
+    static bool buildTable(InflateTable *table, const uint8_t *lengths, uint16_t count);
+};
+
+#endif /* __FLINT_INFLATER_H */
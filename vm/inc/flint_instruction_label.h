@@ -20,12 +20,17 @@ static constexpr void *opcodeLabels[256] = {
     &&op_dreturn, &&op_areturn, &&op_return, &&op_getstatic, &&op_putstatic, &&op_getfield, &&op_putfield, &&op_invokevirtual,
     &&op_invokespecial, &&op_invokestatic, &&op_invokeinterface, &&op_invokedynamic, &&op_new, &&op_newarray, &&op_anewarray,
     &&op_arraylength, &&op_athrow, &&op_checkcast, &&op_instanceof, &&op_monitorenter, &&op_monitorexit, &&op_wide, &&op_multianewarray,
-    &&op_ifnull, &&op_ifnonnull, &&op_goto_w, &&op_jsrw, &&op_breakpoint, &&op_breakpoint_dummy, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-    &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-    &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-    &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-    &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-    &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_exit,
+    &&op_ifnull, &&op_ifnonnull, &&op_goto_w, &&op_jsrw, &&op_breakpoint, &&op_breakpoint_dummy, &&op_invokevirtual_ic,
+    &&op_invokeinterface_ic, &&op_ldc_quick, &&op_ldc_w_quick, &&op_getstatic_quick, &&op_getstatic_wide_quick,
+    &&op_getstatic_obj_quick, &&op_putstatic_byte_quick, &&op_putstatic_short_quick, &&op_putstatic_quick,
+    &&op_putstatic_wide_quick, &&op_putstatic_obj_quick, &&op_getfield_quick, &&op_getfield_wide_quick, &&op_getfield_obj_quick,
+    &&op_putfield_byte_quick, &&op_putfield_short_quick, &&op_putfield_quick, &&op_putfield_wide_quick, &&op_putfield_obj_quick,
+    &&op_invokevirtual_quick, &&op_aload_0_getfield, &&op_iload_iload_iadd, &&op_iload_0_iload_iadd, &&op_iload_1_iload_iadd,
+    &&op_iload_2_iload_iadd, &&op_iload_3_iload_iadd, &&op_iload_iconst_if_icmp, &&op_iload_0_iconst_if_icmp,
+    &&op_iload_1_iconst_if_icmp, &&op_iload_2_iconst_if_icmp, &&op_iload_3_iconst_if_icmp, &&op_aload_arraylength,
+    &&op_aload_0_arraylength, &&op_aload_1_arraylength, &&op_aload_2_arraylength, &&op_aload_3_arraylength, &&op_iinc_goto,
+    &&op_lookupswitch_dense, &&op_invokestatic_quick, &&op_invokespecial_quick, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
+    &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_exit,
 };
 
 static constexpr void *opcodeLabelsExit[256] = {
@@ -14,6 +14,8 @@ public:
 
     bool isPrimitive(void) const;
     bool isArray(void) const;
+    uint8_t getDimensions(void) const;
+    JClass *getElementType(void) const;
 
     JClass *getNestHost(class FExec *ctx);
 
@@ -22,13 +24,17 @@ public:
 
     uint8_t componentSize() const;
 private:
-    JClass(const char *typeName, ClassLoader *loader);
+    JClass(const char *typeName, ClassLoader *loader, uint32_t fieldsSize);
     JClass(const JClass &) = delete;
     void operator=(const JClass &) = delete;
 
-    static uint32_t size(void);
+    void setElementType(JClass *type);
+
+    static uint32_t size(uint32_t fieldsSize);
+    static uint32_t fieldsOffset(void);
 
     friend class Flint;
+    friend class JObject;
 };
 
 #endif /* __FLINT_JAVA_CLASS_H */
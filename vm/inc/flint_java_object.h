@@ -5,6 +5,7 @@
 #include "flint_std.h"
 #include "flint_list.h"
 #include "flint_fields_data.h"
+#include "flint_monitor.h"
 
 class JObject : public ListNode {
 protected:
@@ -14,17 +15,13 @@ private:
 public:
     class JClass * const type;  /* NULL if JClass */
 private:
-    uint32_t monitorCount;
-    uint32_t ownId;
+    LockWord monitor;
 protected:
     uint8_t data[];
 public:
     const char *getTypeName(void) const;
 
-    bool initFields(class Flint *flint, class FExec *ctx, class ClassLoader *loader);
-
     FieldValue *getField(class FExec *ctx, ConstField *field) const;
-    FieldValue *getField(class FExec *ctx, const char *name) const;
     FieldValue *getFieldByIndex(uint32_t index) const;
 
     void clearData(void);
@@ -40,8 +37,6 @@ protected:
     JObject(const JObject &) = delete;
     void operator=(const JObject &) = delete;
 
-    void destroy(class Flint *flint);
-
     friend class Flint;
     friend class FExec;
     friend class FDbg;
@@ -4,6 +4,7 @@
 
 #include "flint_std.h"
 #include "flint_const_pool.h"
+#include "flint_default_conf.h"
 
 class ExceptionTable {
 public:
@@ -19,12 +20,34 @@ private:
     friend class ClassLoader;
 };
 
+class InlineCache {
+private:
+    uint16_t poolIndex;
+    volatile bool megamorphic;
+    uint8_t argc;
+    uint16_t tableIndex;    /* Used by invokevirtual_quick */
+    struct {
+        class JClass * volatile type;
+        class MethodInfo * volatile target;
+    } entries[INLINE_CACHE_SIZE];
+
+    InlineCache(const InlineCache &) = delete;
+    void operator=(const InlineCache &) = delete;
+
+    friend class FExec;
+    friend class ClassLoader;
+    friend class StackMap;
+};
+
 class CodeAttribute {
 private:
     uint16_t maxStack;
     uint16_t maxLocals;
     uint32_t codeLength;
     uint16_t exceptionLength;
+    uint16_t inlineCacheCount;
+    InlineCache *inlineCaches;
+    class StackMap *stackMap;       /* NULL if the frames of this method are scanned conservatively */
     uint8_t data[];
 
     CodeAttribute(const CodeAttribute &) = delete;
@@ -32,6 +55,7 @@ private:
 
     friend class MethodInfo;
     friend class ClassLoader;
+    friend class StackMap;
 };
 
 typedef enum : uint16_t {
@@ -53,9 +77,14 @@ typedef enum : uint16_t {
     METHOD_CLINIT = 0x8000,
 } MethodAccessFlag;
 
+#define NON_VIRTUAL_INDEX           0xFFFF
+
 class MethodInfo {
 public:
     MethodAccessFlag accessFlag;
+private:
+    uint16_t tableIndex;    /* Slot in the vtable (class method) or in the itable (interface method) */
+public:
     class ClassLoader * const loader;
     union {
         struct {
@@ -76,11 +105,14 @@ public:
     uint16_t getMaxStack(void) const;
     uint16_t getExceptionLength(void) const;
     ExceptionTable *getException(uint16_t index) const;
+    InlineCache *getInlineCache(uint16_t index) const;
+    const class StackMap *getStackMap(void) const;
 private:
     MethodInfo(ClassLoader *loader, MethodAccessFlag accessFlag, const char *name, const char *desc);
     MethodInfo(const MethodInfo &) = delete;
     void operator=(const MethodInfo &) = delete;
 
+    friend class FExec;
     friend class ClassLoader;
 };
 
@@ -0,0 +1,45 @@
+
+#ifndef __FLINT_MONITOR_H
+#define __FLINT_MONITOR_H
+
+#include <atomic>
+#include "flint_std.h"
+
+class Monitor {
+private:
+    class FExec *owner;
+    class FExec *entryQueue;        /* Threads blocked in monitorenter, linked through FExec::monitorNext */
+    class FExec *waitSet;           /* Threads blocked in Object.wait */
+
+    Monitor(class FExec *owner);
+    Monitor(const Monitor &) = delete;
+    void operator=(const Monitor &) = delete;
+
+    static void enqueue(class FExec **queue, class FExec *exec);
+    static bool remove(class FExec **queue, class FExec *exec);
+
+    friend class Flint;
+    friend class LockWord;
+};
+
+class LockWord {
+private:
+    /*
+     * 0 when free, the owning FExec while thin locked, or (Monitor * | 0x01) once inflated.
+     * A monitor is inflated the first time the lock is contended or waited on and stays until its object is freed
+     */
+    std::atomic<uint32_t> word;
+    uint32_t count;                 /* Recursion count, only written by the owner */
+public:
+    LockWord(void);
+
+    class FExec *getOwner(void) const;
+    Monitor *getMonitor(void) const;
+private:
+    LockWord(const LockWord &) = delete;
+    void operator=(const LockWord &) = delete;
+
+    friend class Flint;
+};
+
+#endif /* __FLINT_MONITOR_H */
@@ -18,7 +18,7 @@ typedef class JString               *jstring;
 typedef class JClass                *jclass;
 typedef class JThread               *jthread;
 typedef class JThrowable            *jthrowable;
-typedef class FieldValue            *jfieldId;
+typedef class FieldInfo             *jfieldId;
 typedef class MethodInfo            *jmethodId;
 
 typedef class JArray                *jarray;
@@ -75,25 +75,27 @@ public:
     virtual jobjectArray newObjectArray(jclass type, uint32_t count) = 0;
 
     virtual jfieldId getFieldId(jobject obj, const char *name) = 0;
-    virtual jbool getBoolField(jfieldId fid) = 0;
-    virtual jbyte getByteField(jfieldId fid) = 0;
-    virtual jchar getCharField(jfieldId fid) = 0;
-    virtual jshort getShortField(jfieldId fid) = 0;
-    virtual jint getIntField(jfieldId fid) = 0;
-    virtual jfloat getFloatField(jfieldId fid) = 0;
-    virtual jlong getLongField(jfieldId fid) = 0;
-    virtual jdouble getDoubleField(jfieldId fid) = 0;
-    virtual jobject getObjField(jfieldId fid) = 0;
-
-    virtual jvoid setBoolField(jfieldId fid, jbool val) = 0;
-    virtual jvoid setByteField(jfieldId fid, jbyte val) = 0;
-    virtual jvoid setCharField(jfieldId fid, jchar val) = 0;
-    virtual jvoid setShortField(jfieldId fid, jshort val) = 0;
-    virtual jvoid setIntField(jfieldId fid, jint val) = 0;
-    virtual jvoid setFloatField(jfieldId fid, jfloat val) = 0;
-    virtual jvoid setLongField(jfieldId fid, jlong val) = 0;
-    virtual jvoid setDoubleField(jfieldId fid, jdouble val) = 0;
-    virtual jvoid setObjField(jfieldId fid, jobject obj) = 0;
+    virtual jbool getBoolField(jobject obj, jfieldId fid) = 0;
+    virtual jbyte getByteField(jobject obj, jfieldId fid) = 0;
+    virtual jchar getCharField(jobject obj, jfieldId fid) = 0;
+    virtual jshort getShortField(jobject obj, jfieldId fid) = 0;
+    virtual jint getIntField(jobject obj, jfieldId fid) = 0;
+    virtual jfloat getFloatField(jobject obj, jfieldId fid) = 0;
+    virtual jlong getLongField(jobject obj, jfieldId fid) = 0;
+    virtual jdouble getDoubleField(jobject obj, jfieldId fid) = 0;
+    virtual jobject getObjField(jobject obj, jfieldId fid) = 0;
+
+    virtual jvoid setBoolField(jobject obj, jfieldId fid, jbool val) = 0;
+    virtual jvoid setByteField(jobject obj, jfieldId fid, jbyte val) = 0;
+    virtual jvoid setCharField(jobject obj, jfieldId fid, jchar val) = 0;
+    virtual jvoid setShortField(jobject obj, jfieldId fid, jshort val) = 0;
+    virtual jvoid setIntField(jobject obj, jfieldId fid, jint val) = 0;
+    virtual jvoid setFloatField(jobject obj, jfieldId fid, jfloat val) = 0;
+    virtual jvoid setLongField(jobject obj, jfieldId fid, jlong val) = 0;
+    virtual jvoid setDoubleField(jobject obj, jfieldId fid, jdouble val) = 0;
+    virtual jvoid setObjField(jobject obj, jfieldId fid, jobject val) = 0;
+    /* Must follow any store of val into obj that does not go through setObjField, e.g. writing an object array directly */
+    virtual jvoid writeBarrier(jobject obj, jobject val) = 0;
 
     virtual jmethodId getMethodId(jclass cls, const char *name, const char *sig) = 0;
     virtual jmethodId getConstructorId(jclass cls, const char *sig) = 0;
@@ -235,6 +235,53 @@ typedef enum : uint8_t {
     OP_BREAKPOINT = 0xCA,
 
     OP_BREAKPOINT_DUMMY = 0xCB,
+    OP_INVOKEVIRTUAL_IC = 0xCC,
+    OP_INVOKEINTERFACE_IC = 0xCD,
+    OP_LDC_QUICK = 0xCE,
+    OP_LDC_W_QUICK = 0xCF,
+    OP_GETSTATIC_QUICK = 0xD0,
+    OP_GETSTATIC_WIDE_QUICK = 0xD1,
+    OP_GETSTATIC_OBJ_QUICK = 0xD2,
+    OP_PUTSTATIC_BYTE_QUICK = 0xD3,
+    OP_PUTSTATIC_SHORT_QUICK = 0xD4,
+    OP_PUTSTATIC_QUICK = 0xD5,
+    OP_PUTSTATIC_WIDE_QUICK = 0xD6,
+    OP_PUTSTATIC_OBJ_QUICK = 0xD7,
+    OP_GETFIELD_QUICK = 0xD8,
+    OP_GETFIELD_WIDE_QUICK = 0xD9,
+    OP_GETFIELD_OBJ_QUICK = 0xDA,
+    OP_PUTFIELD_BYTE_QUICK = 0xDB,
+    OP_PUTFIELD_SHORT_QUICK = 0xDC,
+    OP_PUTFIELD_QUICK = 0xDD,
+    OP_PUTFIELD_WIDE_QUICK = 0xDE,
+    OP_PUTFIELD_OBJ_QUICK = 0xDF,
+    OP_INVOKEVIRTUAL_QUICK = 0xE0,
+
+    /* Superinstructions, the class loader writes them over the first opcode of a sequence and leaves the rest as is */
+    OP_ALOAD_0_GETFIELD = 0xE1,
+    OP_ILOAD_ILOAD_IADD = 0xE2,
+    OP_ILOAD_0_ILOAD_IADD = 0xE3,
+    OP_ILOAD_1_ILOAD_IADD = 0xE4,
+    OP_ILOAD_2_ILOAD_IADD = 0xE5,
+    OP_ILOAD_3_ILOAD_IADD = 0xE6,
+    OP_ILOAD_ICONST_IF_ICMP = 0xE7,
+    OP_ILOAD_0_ICONST_IF_ICMP = 0xE8,
+    OP_ILOAD_1_ICONST_IF_ICMP = 0xE9,
+    OP_ILOAD_2_ICONST_IF_ICMP = 0xEA,
+    OP_ILOAD_3_ICONST_IF_ICMP = 0xEB,
+    OP_ALOAD_ARRAYLENGTH = 0xEC,
+    OP_ALOAD_0_ARRAYLENGTH = 0xED,
+    OP_ALOAD_1_ARRAYLENGTH = 0xEE,
+    OP_ALOAD_2_ARRAYLENGTH = 0xEF,
+    OP_ALOAD_3_ARRAYLENGTH = 0xF0,
+    OP_IINC_GOTO = 0xF1,
+
+    /* A lookupswitch whose keys are consecutive, written when its table is converted to native byte order */
+    OP_LOOKUPSWITCH_DENSE = 0xF2,
+
+    /* Written once the target is resolved and its class is initialized, like the quick forms above */
+    OP_INVOKESTATIC_QUICK = 0xF3,
+    OP_INVOKESPECIAL_QUICK = 0xF4,
     OP_UNKNOW = 0xFE,
     OP_EXIT = 0xFF,
 } FlintOpCode;
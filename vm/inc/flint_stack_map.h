@@ -0,0 +1,28 @@
+
+#ifndef __FLINT_STACK_MAP_H
+#define __FLINT_STACK_MAP_H
+
+#include "flint_std.h"
+
+/*
+ * Reference maps of a method, one per call site (invoke*, and new/getstatic/putstatic which may run <clinit>).
+ * A bit is set for each local and operand stack slot that holds a reference when the site is reached
+ */
+class StackMap {
+private:
+    uint16_t siteCount;
+    uint16_t wordCount;             /* Bitmap words per site */
+    uint32_t records[];             /* Per site in ascending pc order: pc | (slot count << 16), then the bitmap */
+public:
+    const uint32_t *find(uint32_t pc, uint16_t *slotCount) const;
+
+    static StackMap *build(class Flint *flint, class ClassLoader *loader, class MethodInfo *method, class CodeAttribute *codeAttr);
+private:
+    StackMap(void) = delete;
+    StackMap(const StackMap &) = delete;
+    void operator=(const StackMap &) = delete;
+
+    class Builder;
+};
+
+#endif /* __FLINT_STACK_MAP_H */
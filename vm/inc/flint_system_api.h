@@ -88,6 +88,11 @@ namespace FlintAPI::Thread {
     void yield(void);
     bool wait(uint32_t ms, uint32_t *notifyValue = NULL);
     void notify(ThreadHandle handle, uint32_t notifyValue);
+    /* Blocks until unpark is called for the current thread or ms elapses (0 waits forever), independent of wait/notify */
+    bool park(uint32_t ms);
+    void unpark(ThreadHandle handle);
+    /* Drops the handle returned by create, the VM no longer uses it. The thread may still be running */
+    void release(ThreadHandle handle);
 };
 
 #ifdef FLINT_API_NET_ENABLED
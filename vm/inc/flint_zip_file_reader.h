@@ -3,17 +3,30 @@
 #define __FLINT_ZIP_FILE_READER_H
 
 #include "flint_file_reader.h"
+#include "flint_zip_index.h"
+#include "flint_inflater.h"
 
 class ZipFileReader : public FileReader {
 private:
-    bool gotoEOCD(void);
-    int32_t gotoCDFH(void);
+    const ZipEntry *entry;
+    Inflater *inflater;
+    uint32_t dataOffset;
+
+    bool gotoEntry(const char *name, uint16_t length, const char *ext);
+    void freeInflater(void);
+protected:
+    int32_t fetch(uint32_t offset, uint8_t *dst, uint32_t size) override;
 public:
     ZipFileReader(void);
-    ZipFileReader(class FExec *ctx, const char *filePath);
+    ZipFileReader(class Flint *flint, class FExec *ctx, const char *filePath);
+
+    bool close(void) override;
+    bool isCompressed(void) const override;
 
     bool gotoFile(const char *name, uint16_t length = 0xFFFF);
     bool gotoClassFile(const char *name, uint16_t length = 0xFFFF);
+
+    const ZipEntry *getEntry(void) const;
 private:
     ZipFileReader(const ZipFileReader &) = delete;
     void operator=(const ZipFileReader &) = delete;
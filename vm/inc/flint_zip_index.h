@@ -0,0 +1,50 @@
+
+#ifndef __FLINT_ZIP_INDEX_H
+#define __FLINT_ZIP_INDEX_H
+
+#include "flint_dictionary.h"
+
+#define ZIP_METHOD_STORED           0
+#define ZIP_METHOD_DEFLATED         8
+
+typedef struct {
+    uint32_t hash;                  /* Hash of the entry name */
+    uint32_t offset;                /* Offset of the local file header */
+    uint32_t compressedSize;
+    uint32_t size;
+    uint16_t method;
+    uint16_t next;                  /* Next entry in the same bucket */
+} ZipEntry;
+
+class ZipIndex : public DictNode {
+private:
+    uint32_t hash;
+    uint16_t entryCount;
+    uint16_t bucketMask;
+    uint16_t *buckets;
+    ZipEntry *entries;
+    char path[];
+public:
+    uint32_t getHashKey(void) const override;
+    int32_t compareKey(const char *key, uint16_t length) const override;
+    int32_t compareKey(DictNode *other) const override;
+
+    const char *getPath(void) const;
+    uint16_t getEntryCount(void) const;
+
+    const ZipEntry *findEntry(uint32_t nameHash) const;
+    const ZipEntry *nextEntry(const ZipEntry *entry) const;
+
+    static ZipIndex *load(class Flint *flint, class FileReader *reader);
+private:
+    ZipIndex(const char *path, uint32_t pathSize, uint16_t capacity, uint16_t bucketCount);
+    ZipIndex(const ZipIndex &) = delete;
+    void operator=(const ZipIndex &) = delete;
+
+    bool readCentralDirectory(class FileReader *reader, uint16_t fileCount);
+    void addEntry(uint32_t nameHash, uint32_t offset, uint32_t compressedSize, uint32_t size, uint16_t method);
+
+    friend class Flint;
+};
+
+#endif /* __FLINT_ZIP_INDEX_H */
@@ -6,16 +6,12 @@
 #include "flint_utf8.h"
 #include "flint_system_api.h"
 #include "flint_fields_data.h"
+#include "flint_stack_map.h"
+#include "flint_heap_dump.h"
 #include "flint_zip_file_reader.h"
 
 alignas(4) static const char outOfMemoryErrorTypeName[] = "java/lang/OutOfMemoryError";
 
-static uint32_t getDimensions(const char *typeName) {
-    const char *text = typeName;
-    while(*text == '[') text++;
-    return (uint32_t)(text - typeName);
-}
-
 static bool isPrimitiveTypes(const char *typeName) {
     if(typeName[1] == 0) switch(typeName[0]) {
         case 'Z':
@@ -50,7 +46,7 @@ static int32_t compareArrayClassName(const char *clsName, uint32_t dimensions, c
     return 0;
 }
 
-Flint::Flint(void) : flintLock(), loaders(), classes(), utf8s(), constStr(), execs(), objs(), globalObjs(), shutdownHook() {
+Flint::Flint(void) : flintLock(), heapLock(), execLock(), utf8Lock(), monitorLock(), loaders(), classes(), utf8s(), constStr(), zipIndexes(), files(), execs(), objs(), globalObjs(), shutdownHook(), heap() {
     this->dbg = NULL;
     this->cwd = NULL;
     this->program = NULL;
@@ -60,8 +56,26 @@ Flint::Flint(void) : flintLock(), loaders(), classes(), utf8s(), constStr(), exe
     this->classOfCloneable = NULL;
     this->classOfSerializable = NULL;
 
+    this->interfaceIdCount = 0;
     this->heapCount = 0;
-    this->objectCountToGc = 0;
+    this->allocatedBytes = 0;
+    this->gcThreshold = GC_MIN_THRESHOLD;
+    this->liveBytes = 0;
+    this->promotedBytes = 0;
+    this->rememberedCount = 0;
+    this->markStackTop = 0;
+    this->markStackOverflow = false;
+    this->minorMarking = false;
+    this->gcPhase = GC_IDLE;
+    this->sweepCursor = NULL;
+    this->nextGcStep = 0;
+    this->sweepTotalBytes = 0;
+    this->sweepSurvivedBytes = 0;
+    this->sweepFreedObjects = 0;
+    memset(&this->gcStats, 0, sizeof(this->gcStats));
+    this->lastCollectionTime = 0;
+    this->lastCollectionAllocated = 0;
+    this->heapDumped = false;
     this->heapStart = (void *)0xFFFFFFFF;
     this->headEnd = (void *)0x00;
 
@@ -86,15 +100,17 @@ bool Flint::isHeapPointer(void *p) {
 }
 
 void *Flint::malloc(FExec *ctx, uint32_t size) {
-    if(++objectCountToGc >= OBJECT_COUNT_TO_GC)
-        gc();
-    void *p = FlintAPI::System::malloc(size);
+    collectIfNeeded();
+    void *p = heapAlloc(size);
     if(p == NULL) {
         gc();
-        p = FlintAPI::System::malloc(size);
+        /* Blocks kept in the TLAB pin their pages, give them back so the pages can join a free run */
+        if(ctx != NULL) releaseTlab(ctx);
+        p = heapAlloc(size);
     }
     if(p == NULL) {
         if(ctx != NULL) {
+            dumpHeapOnOom();
             JClass *excpCls = Flint::findClass(NULL, outOfMemoryErrorTypeName);
             if(excpCls != NULL)
                 ctx->throwNew(excpCls);
@@ -103,20 +119,39 @@ void *Flint::malloc(FExec *ctx, uint32_t size) {
         }
     }
     else {
+        heapLock.lock();
         updateHeapRegion(p);
         heapCount++;
+        allocatedBytes += size;
+        gcStats.totalAllocatedBytes += size;
+        heapLock.unlock();
     }
     return p;
 }
 
 void *Flint::realloc(FExec *ctx, void *p, uint32_t size) {
-    p = FlintAPI::System::realloc(p, size);
-    if(p == NULL) {
+    heapLock.lock();
+    uint32_t blockSize = heap.getBlockSize(p);
+    heapLock.unlock();
+    if(blockSize != 0) {
+        /* Slab blocks can not grow in place, move it to a block of the new size */
+        if(size <= blockSize) return p;
+        void *newBlock = Flint::malloc(ctx, size);
+        if(newBlock != NULL) {
+            memcpy(newBlock, p, blockSize);
+            Flint::free(p);
+        }
+        return newBlock;
+    }
+    void *newBlock = FlintAPI::System::realloc(p, size);
+    if(newBlock == NULL) {
         gc();
-        p = FlintAPI::System::malloc(size);
+        newBlock = FlintAPI::System::realloc(p, size);
     }
+    p = newBlock;
     if(p == NULL) {
         if(ctx != NULL) {
+            dumpHeapOnOom();
             JClass *excpCls = Flint::findClass(NULL, outOfMemoryErrorTypeName);
             if(excpCls != NULL)
                 ctx->throwNew(excpCls);
@@ -124,14 +159,84 @@ void *Flint::realloc(FExec *ctx, void *p, uint32_t size) {
                 ctx->excp = (JThrowable *)((uint32_t)outOfMemoryErrorTypeName | 0x01);
         }
     }
-    else
+    else {
+        heapLock.lock();
         updateHeapRegion(p);
+        allocatedBytes += size;
+        gcStats.totalAllocatedBytes += size;
+        heapLock.unlock();
+    }
+    return p;
+}
+
+void *Flint::heapAlloc(uint32_t size) {
+    heapLock.lock();
+    void *p = heap.alloc(size);
+    heapLock.unlock();
+    if(p == NULL) p = FlintAPI::System::malloc(size);
+    if(p == NULL) {
+        /* The system heap may have enough free memory in total but no block large enough */
+        heapLock.lock();
+        p = heap.allocLarge(size);
+        heapLock.unlock();
+    }
     return p;
 }
 
+/*
+ * Small objects come from the thread's TLAB, a list of slab blocks per size class taken from the heap
+ * TLAB_BLOCK_COUNT at a time, so only the refill needs heapLock. ctx must belong to the calling thread
+ */
+void *Flint::allocObject(FExec *ctx, uint32_t size) {
+    if(ctx != NULL) {
+        int32_t sizeClass = FHeap::getSizeClass(size);
+        if(sizeClass >= 0) {
+            void *p = ctx->tlab[sizeClass];
+            if(p == NULL) p = refillTlab(ctx, sizeClass);
+            if(p != NULL) {
+                ctx->tlab[sizeClass] = *(void **)p;
+                return p;
+            }
+        }
+    }
+    return Flint::malloc(ctx, size);
+}
+
+void *Flint::refillTlab(FExec *ctx, uint8_t sizeClass) {
+    collectIfNeeded();
+    uint32_t count;
+    heapLock.lock();
+    void *list = heap.allocBatch(sizeClass, TLAB_BLOCK_COUNT, &count);
+    for(void *block = list; block != NULL; block = *(void **)block)
+        updateHeapRegion(block);
+    heapCount += count;
+    allocatedBytes += count * FHeap::getClassSize(sizeClass);
+    gcStats.totalAllocatedBytes += count * FHeap::getClassSize(sizeClass);
+    heapLock.unlock();
+    ctx->tlab[sizeClass] = list;
+    return list;
+}
+
+void Flint::releaseTlab(FExec *exec) {
+    heapLock.lock();
+    for(uint32_t i = 0; i < HEAP_SIZE_CLASS_COUNT; i++) {
+        for(void *block = exec->tlab[i]; block != NULL;) {
+            void *next = *(void **)block;
+            heap.free(block);
+            heapCount--;
+            block = next;
+        }
+        exec->tlab[i] = NULL;
+    }
+    heapLock.unlock();
+}
+
 void Flint::free(void *p) {
-    FlintAPI::System::free(p);
+    heapLock.lock();
+    bool isSlab = heap.free(p);
     heapCount--;
+    heapLock.unlock();
+    if(!isSlab) FlintAPI::System::free(p);
 }
 
 void Flint::lock(void) {
@@ -142,6 +247,121 @@ void Flint::unlock(void) {
     flintLock.unlock();
 }
 
+static void unparkExec(FExec *exec) {
+    FlintAPI::Thread::unpark(exec->getOwnerThread()->getHandle());
+}
+
+bool Flint::monitorEnter(FExec *ctx, LockWord *lock) {
+    uint32_t expected = 0;
+    if(lock->word.compare_exchange_strong(expected, (uint32_t)ctx, std::memory_order_acquire)) {
+        lock->count = 1;
+        return true;
+    }
+    if(lock->getOwner() == ctx) {
+        if(lock->count == 0xFFFFFFFF) {
+            ctx->throwNew(findClass(ctx, "java/lang/IllegalMonitorStateException"));
+            return false;
+        }
+        lock->count++;
+        return true;
+    }
+
+    /* Contended, inflate the lock and queue up behind the owner */
+    Monitor *spare = NULL;
+    while(true) {
+        uint32_t value = lock->word.load(std::memory_order_acquire);
+        if(value == 0) {
+            if(lock->word.compare_exchange_strong(value, (uint32_t)ctx, std::memory_order_acquire)) {
+                lock->count = 1;
+                break;
+            }
+            continue;
+        }
+        if(!(value & 0x01) && spare == NULL) {
+            spare = (Monitor *)Flint::malloc(ctx, sizeof(Monitor));
+            if(spare == NULL) return false;
+            new (spare)Monitor(NULL);
+            continue;
+        }
+        monitorLock.lock();
+        value = lock->word.load(std::memory_order_acquire);
+        if(value == 0) {
+            monitorLock.unlock();
+            continue;
+        }
+        Monitor *mon = (Monitor *)(value & ~0x01);
+        if(!(value & 0x01)) {
+            spare->owner = (FExec *)value;
+            if(!lock->word.compare_exchange_strong(value, (uint32_t)spare | 0x01, std::memory_order_acq_rel)) {
+                monitorLock.unlock();
+                continue;
+            }
+            mon = spare;
+            spare = NULL;
+        }
+        if(mon->owner == NULL) {
+            mon->owner = ctx;
+            lock->count = 1;
+            monitorLock.unlock();
+            break;
+        }
+        Monitor::enqueue(&mon->entryQueue, ctx);
+        monitorLock.unlock();
+
+        FlintAPI::Thread::park(0);
+
+        monitorLock.lock();
+        Monitor::remove(&mon->entryQueue, ctx);
+        if(ctx->hasTerminateRequest()) {
+            /* Pass a wake-up we may have consumed on to the next thread in line */
+            if(mon->owner == NULL && mon->entryQueue != NULL)
+                unparkExec(mon->entryQueue);
+            monitorLock.unlock();
+            if(spare != NULL) Flint::free(spare);
+            return false;
+        }
+        monitorLock.unlock();
+    }
+    if(spare != NULL) Flint::free(spare);
+    return true;
+}
+
+void Flint::monitorExit(FExec *ctx, LockWord *lock) {
+    if(lock->getOwner() != ctx || lock->count == 0) return;
+    if(--lock->count > 0) return;
+    uint32_t expected = (uint32_t)ctx;
+    if(lock->word.compare_exchange_strong(expected, 0, std::memory_order_release)) return;
+    Monitor *mon = lock->getMonitor();
+    monitorLock.lock();
+    mon->owner = NULL;
+    if(mon->entryQueue != NULL)
+        unparkExec(mon->entryQueue);
+    monitorLock.unlock();
+}
+
+Monitor *Flint::inflateMonitor(FExec *ctx, LockWord *lock) {
+    Monitor *mon = lock->getMonitor();
+    if(mon != NULL) return mon;
+    mon = (Monitor *)Flint::malloc(ctx, sizeof(Monitor));
+    if(mon == NULL) return NULL;
+    new (mon)Monitor(ctx);
+    uint32_t expected = (uint32_t)ctx;
+    monitorLock.lock();
+    bool inflated = lock->word.compare_exchange_strong(expected, (uint32_t)mon | 0x01, std::memory_order_acq_rel);
+    monitorLock.unlock();
+    if(inflated) return mon;
+    /* A contending thread inflated it first */
+    Flint::free(mon);
+    return lock->getMonitor();
+}
+
+void Flint::freeMonitor(LockWord *lock) {
+    Monitor *mon = lock->getMonitor();
+    if(mon != NULL) Flint::free(mon);
+    lock->word.store(0, std::memory_order_relaxed);
+    lock->count = 0;
+}
+
 FDbg *Flint::getDebugger(void) {
     return Flint::dbg;
 }
@@ -279,59 +499,77 @@ int16_t Flint::resolvePath(const char *path, uint16_t length, char *buff, uint16
 }
 
 const char *Flint::getUtf8(FExec *ctx, const char *utf8, uint16_t length) {
-    lock();
-
+    utf8Lock.lock();
     Utf8DictNode *utf8Node = utf8s.find(utf8, length);
-    if(utf8Node != NULL) { unlock(); return utf8Node->getValue(); }
+    utf8Lock.unlock();
+    if(utf8Node != NULL) return utf8Node->getValue();
 
+    /* Allocate without utf8Lock since malloc may run the GC, then check again before adding */
     uint16_t len = strnlen(utf8, length);
+    Utf8DictNode *newNode = (Utf8DictNode *)Flint::malloc(ctx, sizeof(Utf8DictNode) + len + 1);
+    if(newNode == NULL) return NULL;
+    new (newNode)Utf8DictNode(utf8, len);
+
+    utf8Lock.lock();
+    utf8Node = utf8s.find(newNode);
+    if(utf8Node == NULL) {
+        utf8s.add(newNode);
+        utf8Node = newNode;
+        newNode = NULL;
+    }
+    utf8Lock.unlock();
 
-    utf8Node = (Utf8DictNode *)Flint::malloc(ctx, sizeof(Utf8DictNode) + len + 1);
-    if(utf8Node == NULL) { unlock(); return NULL; }
-    new (utf8Node)Utf8DictNode(utf8, len);
-    utf8s.add(utf8Node);
-
-    unlock();
+    if(newNode != NULL) Flint::free(newNode);
     return utf8Node->getValue();
 }
 
-const char *Flint::getArrayClassName(FExec *ctx, const char *clsName, uint8_t dimensions) {
-    lock();
+Utf8DictNode *Flint::findArrayClassName(uint32_t hash, const char *clsName, uint8_t dimensions) {
+    Utf8DictNode *node = (Utf8DictNode *)utf8s.root;
+    while(node) {
+        int32_t cmp = hash - node->getHashKey();
+        if(cmp == 0) cmp = compareArrayClassName(clsName, dimensions, node->value);
+        if(cmp == 0) return node;
+        else if(cmp < 0) node = (Utf8DictNode *)node->left;
+        else node = (Utf8DictNode *)node->right;
+    }
+    return NULL;
+}
 
+const char *Flint::getArrayClassName(FExec *ctx, const char *clsName, uint8_t dimensions) {
     uint32_t hash = 0;
     bool isObjectType = !isPrimitiveTypes(clsName) && clsName[0] != '[';
-    Utf8DictNode *utf8Node = NULL;
-    do {
-        if(utf8s.root == NULL) break;
-        for(uint8_t i = 0; i < dimensions; i++) hash = Hash("[", 1, hash);
-        if(isObjectType) hash = Hash("L", 1, hash);
-        hash = Hash(clsName, 0xFFFF, hash);
-        if(isObjectType) hash = Hash(";", 1, hash);
-        Utf8DictNode *node = (Utf8DictNode *)utf8s.root;
-        while(node) {
-            int32_t cmp = hash - node->getHashKey();
-            if(cmp == 0) cmp = compareArrayClassName(clsName, dimensions, node->value);
-            if(cmp == 0) { utf8Node = node; break; }
-            else if(cmp < 0) node = (Utf8DictNode *)node->left;
-            else node = (Utf8DictNode *)node->right;
-        }
-    } while(false);
-    if(utf8Node != NULL) { unlock(); return utf8Node->getValue(); }
+    for(uint8_t i = 0; i < dimensions; i++) hash = Hash("[", 1, hash);
+    if(isObjectType) hash = Hash("L", 1, hash);
+    hash = Hash(clsName, 0xFFFF, hash);
+    if(isObjectType) hash = Hash(";", 1, hash);
+
+    utf8Lock.lock();
+    Utf8DictNode *utf8Node = findArrayClassName(hash, clsName, dimensions);
+    utf8Lock.unlock();
+    if(utf8Node != NULL) return utf8Node->getValue();
 
     uint32_t len = strlen(clsName);
-    utf8Node = (Utf8DictNode *)Flint::malloc(ctx, sizeof(Utf8DictNode) + dimensions + len + 1 + (isObjectType ? 2 : 0));
-    if(utf8Node == NULL) { unlock(); return NULL; }
-    new (utf8Node)Utf8DictNode();
-    utf8Node->hash = hash;
-    char *txt = utf8Node->value;
-    while(dimensions--) *txt++ = '[';
+    Utf8DictNode *newNode = (Utf8DictNode *)Flint::malloc(ctx, sizeof(Utf8DictNode) + dimensions + len + 1 + (isObjectType ? 2 : 0));
+    if(newNode == NULL) return NULL;
+    new (newNode)Utf8DictNode();
+    newNode->hash = hash;
+    char *txt = newNode->value;
+    for(uint8_t i = 0; i < dimensions; i++) *txt++ = '[';
     if(isObjectType) *txt++ = 'L';
-    while(*clsName) *txt++ = *clsName++;
+    for(const char *name = clsName; *name;) *txt++ = *name++;
     if(isObjectType) *txt++ = ';';
     *txt = 0;
-    utf8s.add(utf8Node);
 
-    unlock();
+    utf8Lock.lock();
+    utf8Node = findArrayClassName(hash, clsName, dimensions);
+    if(utf8Node == NULL) {
+        utf8s.add(newNode);
+        utf8Node = newNode;
+        newNode = NULL;
+    }
+    utf8Lock.unlock();
+
+    if(newNode != NULL) Flint::free(newNode);
     return utf8Node->getValue();
 }
 
@@ -340,24 +578,7 @@ bool Flint::isInstanceof(FExec *ctx, JObject *obj, JClass *type) {
     return isAssignableFrom(ctx, objType, type);
 }
 
-bool Flint::isAssignableFromInterface(FExec *ctx, JClass *fromType, JClass *toIfType) {
-    while(fromType != NULL) {
-        ClassLoader *loader = fromType->getClassLoader();
-        uint16_t ifCount = loader->getInterfacesCount();
-
-        for(uint32_t i = 0; i < ifCount; i++) {
-            JClass *iface = loader->getInterface(ctx, i);
-            if(iface == NULL) return false;
-            if(iface == toIfType) return true;
-            if(isAssignableFromInterface(ctx, iface, toIfType)) return true;
-        }
-
-        fromType = loader->getSuperClass(ctx);
-    }
-    return false;
-}
-
-static JClass *getBaseCompType(Flint *flint, FExec *ctx, JClass *arrayType) {
+static JClass *findElementType(Flint *flint, FExec *ctx, JClass *arrayType) {
     const char *name = arrayType->getTypeName();
     uint32_t len = 0;
     while(*name == '[') name++;
@@ -378,18 +599,32 @@ static JClass *getBaseCompType(Flint *flint, FExec *ctx, JClass *arrayType) {
     return flint->findClass(ctx, name, len);
 }
 
+/* Returns the innermost component class of an array class, it is looked up once and kept in the array class */
+JClass *Flint::getElementType(FExec *ctx, JClass *arrayType) {
+    JClass *elementType = arrayType->getElementType();
+    if(elementType != NULL) return elementType;
+    elementType = findElementType(this, ctx, arrayType);
+    if(elementType != NULL) arrayType->setElementType(elementType);
+    return elementType;
+}
+
+/* The caller holds flintLock */
+uint16_t Flint::newInterfaceId(void) {
+    return ++interfaceIdCount;
+}
+
 bool Flint::isAssignableFrom(FExec *ctx, JClass *fromType, JClass *toType) {
     if(fromType == toType) return true;
 
-    uint8_t dim1 = getDimensions(fromType->getTypeName());
-    uint8_t dim2 = getDimensions(toType->getTypeName());
+    uint8_t dim1 = fromType->getDimensions();
+    uint8_t dim2 = toType->getDimensions();
 
     if(dim1 > 0) {
-        fromType = getBaseCompType(this, ctx, fromType);
+        fromType = getElementType(ctx, fromType);
         if(fromType == NULL) return false;
     }
     if(dim2 > 0) {
-        toType = getBaseCompType(this, ctx, toType);
+        toType = getElementType(ctx, toType);
         if(toType == NULL) return false;
     }
 
@@ -413,15 +648,7 @@ bool Flint::isAssignableFrom(FExec *ctx, JClass *fromType, JClass *toType) {
     if(fromType->isPrimitive() || toType->isPrimitive())
         return fromType == toType;
 
-    if(toType->getClassLoader()->getAccessFlag() & CLASS_INTERFACE)
-        return isAssignableFromInterface(ctx, fromType, toType);
-    else {
-        while(fromType != NULL) {
-            fromType = fromType->getClassLoader()->getSuperClass(ctx);
-            if(fromType == toType) return true;
-        }
-        return false;
-    }
+    return fromType->getClassLoader()->isSubclassOf(ctx, toType->getClassLoader());
 }
 
 FExec *Flint::newExecution(FExec *ctx, JThread *owner) {
@@ -445,19 +672,28 @@ FExec *Flint::newExecution(FExec *ctx, JThread *owner) {
     owner->setStackSize(stackSize);
 
     new (newExec)FExec(this, owner, stackSize);
-    lock();
+    execLock.lock();
     execs.add(newExec);
-    unlock();
+    execLock.unlock();
     return newExec;
 }
 
 void Flint::freeExecution(FExec *exec) {
     bool isDaemon = exec->getOwnerThread()->isDaemon();
-    lock();
-
-    exec->getOwnerThread()->setHandle(NULL);
+    heapLock.lock();
+    /* Keep them young, they may be all that references the young objects of other threads */
+    exec->allocLock.lock();
+    exec->newObjs.forEach([this](JObject *obj) { youngObjs.add(obj); });
+    exec->allocLock.unlock();
+    heapLock.unlock();
+    releaseTlab(exec);
+    execLock.lock();
+
+    /* Under execLock, interruptThread reads the handle with it held */
+    JThread *owner = exec->getOwnerThread();
+    FlintAPI::Thread::release(owner->getHandle());
+    owner->setHandle(NULL);
     execs.remove(exec);
-    Flint::free(exec);
 
     if(isDaemon == false) {
         bool hasNoneDaemon = false;
@@ -470,7 +706,8 @@ void Flint::freeExecution(FExec *exec) {
         if(!hasNoneDaemon) terminateRequest();
     }
 
-    unlock();
+    execLock.unlock();
+    Flint::free(exec);
 
     if(termCb != NULL && !isRunning()) {
         if(dbg == NULL || !dbg->restartRequested())
@@ -478,17 +715,27 @@ void Flint::freeExecution(FExec *exec) {
     }
 }
 
+void Flint::interruptThread(JThread *thread) {
+    execLock.lock();
+    FlintAPI::Thread::ThreadHandle handle = thread->getHandle();
+    /* Not started yet or already finished */
+    if(handle != NULL) {
+        FlintAPI::Thread::notify(handle, (uint32_t)handle);
+        FlintAPI::Thread::unpark(handle);
+    }
+    execLock.unlock();
+}
+
 JObject *Flint::newObject(FExec *ctx, JClass *type) {
     if(type == NULL) return NULL;
-    JObject *newObj = (JObject *)Flint::malloc(ctx, sizeof(JObject) + sizeof(FieldsData));
+    ClassLoader *loader = type->getClassLoader();
+    if(!loader->initLayout(ctx)) return NULL;
+    uint32_t size = loader->getInstanceSize();
+    JObject *newObj = (JObject *)allocObject(ctx, sizeof(JObject) + size);
     if(newObj == NULL) return NULL;
-    new (newObj)JObject(sizeof(FieldsData), type);
-
-    if(newObj->initFields(this, ctx, type->getClassLoader()) == false) { Flint::free(newObj); return NULL; }
-
-    lock();
-    objs.add(newObj);
-    unlock();
+    new (newObj)JObject(size, type);
+    newObj->clearData();
+    addObject(ctx, newObj);
 
     return newObj;
 }
@@ -501,13 +748,10 @@ JObject *Flint::newArray(FExec *ctx, JClass *type, uint32_t count) {
             ctx->throwNew(Flint::findClass(ctx, "java/lang/IllegalArgumentException"));
         return NULL;
     }
-    JObject *newObj = (JObject *)Flint::malloc(ctx, sizeof(JObject) + compSz * count);
+    JObject *newObj = (JObject *)allocObject(ctx, sizeof(JObject) + compSz * count);
     if(newObj == NULL) return NULL;
     new (newObj)JObject(compSz * count, type);
-
-    lock();
-    objs.add(newObj);
-    unlock();
+    addObject(ctx, newObj);
 
     return newObj;
 }
@@ -615,18 +859,19 @@ JClass *Flint::newClass(FExec *ctx, const char *clsName, uint16_t length, uint8_
     JClass *clsOfCls = getClassOfClass(ctx);
     if(clsOfCls == NULL) return NULL;
     ClassLoader *jClsLoader = clsOfCls->getClassLoader();
-    if(jClsLoader == NULL) return NULL;
+    if(jClsLoader == NULL || !jClsLoader->initLayout(ctx)) return NULL;
 
-    JClass *cls = (JClass *)Flint::malloc(ctx, JClass::size());
+    uint32_t fieldsSize = jClsLoader->getInstanceSize();
+    JClass *cls = (JClass *)Flint::malloc(ctx, JClass::size(fieldsSize));
     if(cls == NULL) return NULL;
     /* Make sure clsName string is managed */
     clsName = ((flag & 0x01) || clsName[0] == '[') ? getUtf8(ctx, clsName, length) : loader->getName();
-    if(clsName == NULL) return NULL;
-    new (cls)JClass(clsName, loader);
-
-    if(cls->initFields(this, ctx, jClsLoader) == false) { Flint::free(cls); return NULL; }
+    if(clsName == NULL) { Flint::free(cls); return NULL; }
+    new (cls)JClass(clsName, loader, fieldsSize);
 
+    heapLock.lock();
     globalObjs.add(cls);
+    heapLock.unlock();
     return cls;
 }
 
@@ -638,18 +883,52 @@ JClass *Flint::newClassOfArray(FExec *ctx, const char *clsName, uint8_t dimensio
 
 JClass *Flint::newClassOfClass(FExec *ctx) {
     ClassLoader *jClsLoader = findLoader(ctx, "java/lang/Class");
-    if(jClsLoader == NULL) return NULL;
+    if(jClsLoader == NULL || !jClsLoader->initLayout(ctx)) return NULL;
 
-    JClass *cls = (JClass *)Flint::malloc(ctx, JClass::size());
+    uint32_t fieldsSize = jClsLoader->getInstanceSize();
+    JClass *cls = (JClass *)Flint::malloc(ctx, JClass::size(fieldsSize));
     if(cls == NULL) return NULL;
-    new (cls)JClass(jClsLoader->getName(), jClsLoader);
-
-    if(cls->initFields(this, ctx, jClsLoader) == false) { Flint::free(cls); return NULL; }
+    new (cls)JClass(jClsLoader->getName(), jClsLoader, fieldsSize);
 
+    heapLock.lock();
     globalObjs.add(cls);
+    heapLock.unlock();
     return cls;
 }
 
+ZipIndex *Flint::getZipIndex(FileReader *reader) {
+    lock();
+    ZipIndex *index = zipIndexes.find(reader->getFilePath());
+    if(index == NULL) {
+        index = ZipIndex::load(this, reader);
+        if(index != NULL) zipIndexes.add(index);
+    }
+    unlock();
+    return index;
+}
+
+FlintAPI::IO::FileHandle Flint::getFileHandle(const char *filePath) {
+    lock();
+    FileDictNode *node = files.find(filePath);
+    if(node == NULL) {
+        FlintAPI::IO::FileHandle handle = FlintAPI::IO::fopen(filePath, FlintAPI::IO::FILE_MODE_READ);
+        if(handle == NULL) {
+            unlock();
+            return NULL;
+        }
+        node = (FileDictNode *)Flint::malloc(NULL, sizeof(FileDictNode) + strlen(filePath) + 1);
+        if(node == NULL) {
+            FlintAPI::IO::fclose(handle);
+            unlock();
+            return NULL;
+        }
+        new (node)FileDictNode(filePath, handle);
+        files.add(node);
+    }
+    unlock();
+    return node->getHandle();
+}
+
 ClassLoader *Flint::findLoader(FExec *ctx, const char *clsName, uint16_t length) {
     lock();
     ClassLoader *loader = loaders.find(clsName, length);
@@ -809,6 +1088,26 @@ JClass *Flint::getClassOfSerializable(FExec *ctx) {
     return classOfSerializable;
 }
 
+ClassLoader *Flint::getFieldsLoader(JObject *obj) {
+    /* A JClass holds the instance fields of java/lang/Class */
+    JClass *cls = (obj->type != NULL) ? obj->type : classOfClass;
+    return cls->getClassLoader();
+}
+
+static MethodInfo *findMethodInInterfaces(FExec *ctx, ClassLoader *loader, ConstNameAndType *nameAndType) {
+    for(uint16_t i = 0; i < loader->getInterfacesCount(); i++) {
+        JClass *ifCls = loader->getInterface(ctx, i);
+        if(ifCls == NULL) return NULL;
+        ClassLoader *ifLoader = ifCls->getClassLoader();
+        MethodInfo *mtInfo = ifLoader->getMethodInfo(ctx, nameAndType);
+        if(mtInfo == NULL && (ctx == NULL || !ctx->hasException()))
+            mtInfo = findMethodInInterfaces(ctx, ifLoader, nameAndType);
+        if(mtInfo != NULL) return mtInfo;
+        if(ctx != NULL && ctx->hasException()) return NULL;
+    }
+    return NULL;
+}
+
 MethodInfo *Flint::findMethod(FExec *ctx, JClass *cls, ConstNameAndType *nameAndType) {
     if(cls == NULL) return NULL;
     ClassLoader *loader = cls->getClassLoader();
@@ -820,6 +1119,15 @@ MethodInfo *Flint::findMethod(FExec *ctx, JClass *cls, ConstNameAndType *nameAnd
         if(super == NULL) break;
         loader = super->getClassLoader();
     }
+    /* Methods declared by super-interfaces (abstract or default) */
+    for(loader = cls->getClassLoader(); loader != NULL;) {
+        MethodInfo *mtInfo = findMethodInInterfaces(ctx, loader, nameAndType);
+        if(mtInfo != NULL) return mtInfo;
+        if(ctx != NULL && ctx->excp != NULL) return NULL;
+        JClass *super = loader->getSuperClass(ctx);
+        if(super == NULL) break;
+        loader = super->getClassLoader();
+    }
     if(ctx != NULL && !ctx->hasException())
         ctx->throwNew(Flint::findClass(ctx, "java/lang/NoSuchMethodError"), "%s.%s", cls->getTypeName(), nameAndType->name);
     return NULL;
@@ -838,7 +1146,9 @@ JString *Flint::getConstString(FExec *ctx, const char *utf8) {
     if(strNode == NULL) { unlock(); freeObject(newStr); return NULL; }
     new (strNode)JStringDictNode(newStr);
 
+    heapLock.lock();
     globalObjs.add(newStr);
+    heapLock.unlock();
     constStr.add(strNode);
 
     unlock();
@@ -856,15 +1166,17 @@ JString *Flint::getConstString(FExec *ctx, JString *str) {
     if(strNode == NULL) { unlock(); return NULL; }
     new (strNode)JStringDictNode(str);
 
+    heapLock.lock();
     globalObjs.add(str);
+    heapLock.unlock();
     constStr.add(strNode);
 
     unlock();
     return str;
 }
 
-void Flint::clearProtLv2Recursion(JObject *obj) {
-    obj->setProtected();
+template <typename T>
+void Flint::forEachReference(JObject *obj, T func) {
     const char *typeName = obj->getTypeName();
     if(typeName[0] == '[') {
         if(typeName[1] == '[' || typeName[1] == 'L') {
@@ -872,150 +1184,694 @@ void Flint::clearProtLv2Recursion(JObject *obj) {
             JObject **data = array->getData();
             uint32_t count = array->getLength();
             for(uint32_t i = 0; i < count; i++) {
-                if(data[i] && (data[i]->getProtected() & 0x01) == 0)
-                    clearProtLv2Recursion(data[i]);
+                if(data[i]) func(data[i]);
             }
         }
     }
     else {
-        FieldsData *fieldData = (FieldsData *)obj->data;
-        if(fieldData->hasObjField()) {
-            for(uint16_t i = 0; i < fieldData->count; i++) {
-                FieldValue *fieldValue = &fieldData->fields[i];
-                const FieldInfo *fieldInfo = fieldValue->getFieldInfo();
-                if(fieldInfo != NULL && (fieldInfo->desc[0] == '[' || fieldInfo->desc[0] == 'L')) {
-                    JObject *tmp = fieldValue->getObj();
-                    if(tmp && (tmp->getProtected() & 0x01) == 0)
-                        clearProtLv2Recursion(tmp);
-                }
+        ClassLoader *loader = getFieldsLoader(obj);
+        uint16_t objCount = loader->hasInstanceObjField();
+        const uint32_t *refMap = loader->getInstanceRefMap();
+        for(uint32_t i = 0; objCount > 0; i++) {
+            for(uint32_t bits = refMap[i]; bits != 0; bits &= bits - 1) {
+                JObject *tmp = obj->getFieldByIndex(i * 32 + __builtin_ctz(bits))->getObj();
+                objCount--;
+                if(tmp) func(tmp);
             }
         }
     }
+}
+
+/* Visits every object on the heap. The caller holds heapLock */
+template <typename T>
+void Flint::forEachObject(T func) {
+    objs.forEach(func);
+    globalObjs.forEach(func);
+    youngObjs.forEach(func);
+    execLock.lock();
+    execs.forEach([&func](FExec *exec) {
+        exec->allocLock.lock();
+        exec->newObjs.forEach(func);
+        exec->allocLock.unlock();
+    });
+    execLock.unlock();
+}
+
+/*
+ * Marking pushes each newly marked object on a fixed size stack instead of recursing, so the depth of a
+ * list or tree does not matter. When the stack is full the object is left marked but unscanned and
+ * finishMark rescans the heap for them
+ */
+void Flint::pushMark(JObject *obj) {
+    if(markStackTop < GC_MARK_STACK_SIZE)
+        markStack[markStackTop++] = obj;
+    else
+        markStackOverflow = true;
+}
+
+/* Marks obj and leaves it on the mark stack to be scanned */
+void Flint::shade(JObject *obj) {
+    if(obj->getProtected() & 0x01) return;
+    if(minorMarking && !isYoung(obj)) return;
+    obj->setProtected();
+    pushMark(obj);
+}
+
+void Flint::drainMarkStack(void) {
+    while(markStackTop > 0) {
+        JObject *obj = markStack[--markStackTop];
+        forEachReference(obj, [this](JObject *ref) { shade(ref); });
+    }
+}
+
+void Flint::markObject(JObject *obj) {
+    shade(obj);
+    drainMarkStack();
+}
+
+void Flint::finishMark(void) {
+    auto rescan = [this](JObject *obj) {
+        if(obj->getProtected() & 0x01) {
+            pushMark(obj);
+            drainMarkStack();
+        }
+    };
+    drainMarkStack();
+    while(markStackOverflow) {
+        markStackOverflow = false;
+        forEachObject(rescan);
+    }
+}
+
+void Flint::clearMark(JObject *obj) {
     obj->clearProtected();
+    pushMark(obj);
+    while(markStackTop > 0) {
+        JObject *tmp = markStack[--markStackTop];
+        forEachReference(tmp, [this](JObject *ref) {
+            if(ref->getProtected() & 0x01) {
+                ref->clearProtected();
+                pushMark(ref);
+            }
+        });
+    }
+    if(markStackOverflow) {
+        /* Outside of the GC only this walk leaves marks behind, so clear every one left */
+        markStackOverflow = false;
+        forEachObject([](JObject *obj) { if(obj->getProtected() & 0x01) obj->clearProtected(); });
+    }
+}
+
+void Flint::addObject(FExec *ctx, JObject *obj) {
+    if(ctx != NULL) {
+        ctx->allocLock.lock();
+        ctx->newObjs.add(obj);
+        ctx->allocLock.unlock();
+    }
+    else {
+        heapLock.lock();
+        objs.add(obj);
+        promotedBytes += sizeof(JObject) + obj->size;
+        heapLock.unlock();
+    }
+}
+
+/* Moves the objects allocated by exec to objs. The caller holds heapLock */
+void Flint::takeNewObjects(FExec *exec) {
+    exec->allocLock.lock();
+    exec->newObjs.forEach([this](JObject *obj) { objs.add(obj); });
+    exec->allocLock.unlock();
+}
+
+/* Unlinks obj from objs, globalObjs or the new object list of the thread that allocated it */
+void Flint::detachObject(JObject *obj) {
+    heapLock.lock();
+    if(obj == sweepCursor) sweepCursor = (JObject *)obj->next;
+    if(objs.isContain(obj)) objs.remove(obj);
+    else if(globalObjs.isContain(obj)) globalObjs.remove(obj);
+    else if(youngObjs.isContain(obj)) youngObjs.remove(obj);
+    else if(obj->ownerList != NULL) {
+        execLock.lock();
+        execs.forEach([obj](FExec *exec) {
+            if(obj->ownerList == &exec->newObjs) {
+                exec->allocLock.lock();
+                exec->newObjs.remove(obj);
+                exec->allocLock.unlock();
+            }
+        });
+        execLock.unlock();
+    }
+    heapLock.unlock();
 }
 
 void Flint::makeToGlobal(JObject *obj) {
-    lock();
+    heapLock.lock();
+    detachObject(obj);
     globalObjs.add(obj);
-    unlock();
+    if(gcPhase == GC_MARKING) shade(obj);
+    /* Its fields may still hold young objects */
+    if(GC_NURSERY_SIZE > 0) remember(obj);
+    heapLock.unlock();
+}
+
+/*
+ * While sweeping, marks can not be used to walk the graph. Only objects still under level 2 protection are
+ * followed, and the ones in objs are moved in front of the sweep so that it does not free them
+ */
+void Flint::releaseProtLv2(JObject *obj) {
+    auto release = [this](JObject *tmp) {
+        tmp->clearProtected();
+        if(objs.isContain(tmp)) {
+            if(tmp == sweepCursor) sweepCursor = (JObject *)tmp->next;
+            objs.add(tmp);
+        }
+        pushMark(tmp);
+    };
+    if(obj->getProtected() != 0x02) return;
+    release(obj);
+    while(markStackTop > 0) {
+        JObject *tmp = markStack[--markStackTop];
+        forEachReference(tmp, [&release](JObject *ref) { if(ref->getProtected() == 0x02) release(ref); });
+    }
+    /* Objects that did not fit on the stack are released, but what they reference keeps its protection */
+    markStackOverflow = false;
 }
 
 void Flint::clearProtLv2(JObject *obj) {
-    lock();
-    clearProtLv2Recursion(obj);
-    unlock();
+    heapLock.lock();
+    if(gcPhase == GC_MARKING) {
+        /* Marking clears the level 2 protection of everything it reaches, and its marks must be kept */
+        shade(obj);
+    }
+    else if(gcPhase == GC_SWEEPING)
+        releaseProtLv2(obj);
+    else {
+        /* Mark first so that cycles are walked once, then clear the marks together with the level 2 protection */
+        markObject(obj);
+        finishMark();
+        clearMark(obj);
+    }
+    /* A native may have filled an object that was promoted while it was still protected without any barrier */
+    if(GC_NURSERY_SIZE > 0 && !isYoung(obj)) remember(obj);
+    heapLock.unlock();
 }
 
-void Flint::clearMarkRecursion(JObject *obj) {
-    obj->clearProtected();
-    const char *typeName = obj->getTypeName();
-    if(typeName[0] == '[') {
-        if(typeName[1] == '[' || typeName[1] == 'L') {
-            JObjectArray *array = (JObjectArray *)obj;
-            JObject **data = array->getData();
-            uint32_t count = array->getLength();
-            for(uint32_t i = 0; i < count; i++) {
-                if(data[i] && (data[i]->getProtected() & 0x01))
-                    clearMarkRecursion(data[i]);
-            }
+bool Flint::isObject(void *p) {
+    if(!isHeapPointer(p)) return false;
+    JObject *obj = (JObject *)p;
+    heapLock.lock();
+    bool ret = objs.isContain(obj) || globalObjs.isContain(obj) || youngObjs.isContain(obj);
+    if(!ret && obj->ownerList != NULL) {
+        execLock.lock();
+        for(ListNode *node = execs.root; node != NULL && !ret; node = node->next)
+            ret = (obj->ownerList == &((FExec *)node)->newObjs);
+        execLock.unlock();
+    }
+    heapLock.unlock();
+    return ret;
+}
+
+bool Flint::isYoung(JObject *obj) {
+    void *list = obj->ownerList;
+    return (list != NULL) && (list != &objs) && (list != &globalObjs);
+}
+
+/* The caller holds heapLock */
+void Flint::remember(JObject *obj) {
+    if(rememberedCount > GC_REMEMBERED_SET_SIZE) return;
+    for(uint32_t i = 0; i < rememberedCount; i++) {
+        if(remembered[i] == obj) return;
+    }
+    if(rememberedCount < GC_REMEMBERED_SET_SIZE)
+        remembered[rememberedCount] = obj;
+    rememberedCount++;
+}
+
+/* The caller holds heapLock */
+void Flint::forget(JObject *obj) {
+    if(rememberedCount > GC_REMEMBERED_SET_SIZE) return;
+    for(uint32_t i = 0; i < rememberedCount; i++) {
+        if(remembered[i] == obj) {
+            remembered[i] = remembered[--rememberedCount];
+            execLock.lock();
+            execs.forEach([obj](FExec *exec) { if(exec->lastRemembered == obj) exec->lastRemembered = NULL; });
+            execLock.unlock();
+            return;
         }
     }
-    else {
-        FieldsData *fieldData = (FieldsData *)obj->data;
-        if(!fieldData->hasObjField()) return;
-        for(uint16_t i = 0; i < fieldData->count; i++) {
-            FieldValue *fieldValue = &fieldData->fields[i];
-            const FieldInfo *fieldInfo = fieldValue->getFieldInfo();
-            if(fieldInfo != NULL && fieldInfo->desc[0] == 'L') {
-                JObject *tmp = fieldValue->getObj();
-                if(tmp && (tmp->getProtected() & 0x01))
-                    clearMarkRecursion(tmp);
-            }
+}
+
+/*
+ * A minor GC does not trace old objects, so an old object given a young one is added to the remembered set.
+ * ctx->lastRemembered skips the lookup when a thread keeps storing into the same object
+ */
+void Flint::writeBarrier(FExec *ctx, JObject *holder, JObject *value) {
+    if(holder == NULL || value == NULL) return;
+    if(gcPhase == GC_MARKING && (value->getProtected() & 0x01) == 0) {
+        /* holder may have been scanned already */
+        heapLock.lock();
+        if(gcPhase == GC_MARKING) shade(value);
+        heapLock.unlock();
+    }
+    if(GC_NURSERY_SIZE == 0) return;
+    if(ctx != NULL && ctx->lastRemembered == holder) return;
+    if(!isYoung(value) || isYoung(holder)) return;
+    heapLock.lock();
+    remember(holder);
+    heapLock.unlock();
+    if(ctx != NULL) ctx->lastRemembered = holder;
+}
+
+void Flint::staticWriteBarrier(ClassLoader *loader, JObject *value) {
+    if(value == NULL) return;
+    if(gcPhase == GC_MARKING && (value->getProtected() & 0x01) == 0) {
+        heapLock.lock();
+        if(gcPhase == GC_MARKING) shade(value);
+        heapLock.unlock();
+    }
+    if(GC_NURSERY_SIZE > 0 && !loader->youngStatics && isYoung(value))
+        loader->youngStatics = true;
+}
+
+void Flint::updateGcThreshold(uint32_t survivedBytes, uint32_t totalBytes) {
+    liveBytes = survivedBytes;
+    allocatedBytes = 0;
+    /* Let the heap grow by a share of what survived, and twice that when the GC found little garbage */
+    uint64_t threshold = (uint64_t)survivedBytes * GC_HEAP_GROWTH_PERCENT / 100;
+    if(totalBytes > 0 && (uint64_t)survivedBytes * 4 >= (uint64_t)totalBytes * 3)
+        threshold *= 2;
+    uint32_t headroom = (survivedBytes < GC_HEAP_BUDGET) ? (GC_HEAP_BUDGET - survivedBytes) : 0;
+    if(threshold > headroom) threshold = headroom;
+    if(threshold < GC_MIN_THRESHOLD) threshold = GC_MIN_THRESHOLD;
+    gcThreshold = (uint32_t)threshold;
+}
+
+/* Marks what obj references without marking obj itself */
+void Flint::markChildren(JObject *obj) {
+    forEachReference(obj, [this](JObject *ref) { markObject(ref); });
+}
+
+void Flint::markStaticFields(ClassLoader *loader) {
+    uint16_t objCount = loader->hasStaticObjField();
+    for(uint16_t i = 0; objCount > 0; i++) {
+        const FieldInfo *fieldInfo = loader->getFieldInfo(i);
+        if((fieldInfo->accessFlag & FIELD_STATIC) && (fieldInfo->desc[0] == 'L' || fieldInfo->desc[0] == '[')) {
+            JObject *obj = loader->getStaticFieldByIndex(fieldInfo->getSlot())->getObj();
+            objCount--;
+            if(obj) shade(obj);
         }
     }
 }
 
-void Flint::markObjectRecursion(JObject *obj) {
-    obj->setProtected();
-    const char *typeName = obj->getTypeName();
-    if(typeName[0] == '[') {
-        if(typeName[1] == '[' || typeName[1] == 'L') {
-            JObjectArray *array = (JObjectArray *)obj;
-            JObject **data = array->getData();
-            uint32_t count = array->getLength();
-            for(uint32_t i = 0; i < count; i++) {
-                if(data[i] && (data[i]->getProtected() & 0x01) == 0)
-                    markObjectRecursion(data[i]);
+/* Shades the thread object, the pending exception and every stack word that points to an object in space */
+void Flint::markExecution(FExec *exec, FList<JObject> *space) {
+    if(exec->ownerThread)
+        shade(exec->ownerThread);
+    if(exec->excp != NULL && ((uint32_t)exec->excp & 0x01) == 0)
+        shade(exec->excp);
+    /*
+     * The running frame is scanned conservatively. Every frame below it is suspended at a call site, the stack map
+     * of that site tells which of its slots hold references. Slots past the map (pushed by a native) and frames
+     * without a map are scanned conservatively too
+     */
+    int32_t startSp = exec->startSp;
+    int32_t endSp = (exec->sp > exec->peakSp) ? exec->sp : exec->peakSp;
+    const uint32_t *refMap = NULL;
+    uint16_t refCount = 0;
+    while(startSp >= 3) {
+        for(int32_t i = startSp; i <= endSp; i++) {
+            if(refMap != NULL) {
+                uint32_t slot = i - startSp - 1;
+                if(i == startSp) continue;
+                if(slot < refCount && !((refMap[slot / 32] >> (slot % 32)) & 0x01)) continue;
             }
+            JObject *obj = (JObject *)exec->stack[i];
+            if(isHeapPointer(obj) && space->isContain(obj))
+                shade(obj);
         }
+        MethodInfo *caller = (MethodInfo *)exec->stack[startSp - 3];
+        uint32_t callerPc = exec->stack[startSp - 2];
+        const StackMap *stackMap = (caller != NULL && callerPc != 0xFFFFFFFF) ? caller->getStackMap() : NULL;
+        refMap = (stackMap != NULL) ? stackMap->find(callerPc, &refCount) : NULL;
+        endSp = startSp - 4;
+        startSp = exec->stack[startSp];
+    }
+}
+
+/*
+ * Objects on the new object lists of the threads and in youngObjs are young, those in objs and globalObjs are old.
+ * A minor GC marks only young objects, from the stacks, the remembered old objects and the static fields
+ * of classes that were given a young object, then moves the survivors to objs. Objects never move in memory
+ */
+void Flint::minorGc(void) {
+    lock();
+    heapLock.lock();
+    execLock.lock();
+    if(gcPhase != GC_IDLE || rememberedCount > GC_REMEMBERED_SET_SIZE) {
+        /* Another thread started a full GC or overflowed the remembered set while this one waited for the locks */
+        execLock.unlock();
+        heapLock.unlock();
+        unlock();
+        if(gcPhase == GC_IDLE) gc();
+        return;
+    }
+    int64_t startTime = FlintAPI::System::getTimeNanos();
+    execs.forEach([this](FExec *exec) {
+        exec->allocLock.lock();
+        exec->newObjs.forEach([this](JObject *obj) { youngObjs.add(obj); });
+        exec->allocLock.unlock();
+        exec->lastRemembered = NULL;
+    });
+    minorMarking = true;
+    for(uint32_t i = 0; i < rememberedCount; i++)
+        markChildren(remembered[i]);
+    rememberedCount = 0;
+    loaders.forEach([this](ClassLoader *ld) {
+        if(ld->youngStatics) {
+            ld->youngStatics = false;
+            markStaticFields(ld);
+        }
+    });
+    execs.forEach([this](FExec *exec) { markExecution(exec, &youngObjs); });
+    /* Protected objects survive anyway, and natives fill them without write barriers */
+    youngObjs.forEach([this](JObject *obj) { if(obj->getProtected() & 0x02) markChildren(obj); });
+    execs.forEach([this](FExec *exec) {
+        exec->allocLock.lock();
+        exec->newObjs.forEach([this](JObject *obj) { markChildren(obj); });
+        exec->allocLock.unlock();
+    });
+    finishMark();
+    minorMarking = false;
+    uint32_t survivedBytes = 0;
+    uint32_t freedBytes = 0;
+    uint32_t freedObjects = 0;
+    youngObjs.forEach([this, &survivedBytes, &freedBytes, &freedObjects](JObject *obj) {
+        uint8_t prot = obj->getProtected();
+        if(prot == 0) {
+            freedBytes += sizeof(JObject) + obj->size;
+            freedObjects++;
+            freeObject(obj);
+        }
+        else {
+            survivedBytes += sizeof(JObject) + obj->size;
+            if(!(prot & 0x02)) obj->clearProtected();
+            objs.add(obj);
+        }
+    });
+    execs.forEach([](FExec *exec) {
+        exec->allocLock.lock();
+        exec->newObjs.forEach([](JObject *obj) { if(obj->getProtected() == 0x01) obj->clearProtected(); });
+        exec->allocLock.unlock();
+    });
+    promotedBytes += survivedBytes;
+    allocatedBytes = 0;
+    gcStats.minorCount++;
+    recordCollection(freedBytes, freedObjects);
+    recordPause(startTime);
+    execLock.unlock();
+    heapLock.unlock();
+    unlock();
+}
+
+/*
+ * Every GC_NURSERY_SIZE allocated bytes run a minor GC, a full GC once the old space has grown by gcThreshold.
+ * With GC_PAUSE_BUDGET_US the full GC is incremental, a slice runs every GC_STEP_SIZE allocated bytes
+ */
+void Flint::collectIfNeeded(void) {
+    if(GC_PAUSE_BUDGET_US > 0 && gcPhase != GC_IDLE) {
+        if(allocatedBytes >= nextGcStep)
+            gcStep(false);
+        return;
+    }
+    bool full;
+    if(GC_NURSERY_SIZE == 0) {
+        if(allocatedBytes < gcThreshold) return;
+        full = true;
     }
     else {
-        FieldsData *fieldData = (FieldsData *)obj->data;
-        uint16_t objCount = fieldData->hasObjField();
-        for(uint16_t i = 0; objCount > 0; i++) {
-            FieldValue *fieldValue = &fieldData->fields[i];
-            const FieldInfo *fieldInfo = fieldValue->getFieldInfo();
-            if(fieldInfo != NULL && (fieldInfo->desc[0] == 'L' || fieldInfo->desc[0] == '[')) {
-                JObject *tmp = fieldValue->getObj();
-                objCount--;
-                if(tmp && (tmp->getProtected() & 0x01) == 0)
-                    markObjectRecursion(tmp);
-            }
+        if(allocatedBytes < GC_NURSERY_SIZE) return;
+        full = (promotedBytes >= gcThreshold) || (rememberedCount > GC_REMEMBERED_SET_SIZE);
+    }
+    if(!full)
+        minorGc();
+    else if(GC_PAUSE_BUDGET_US > 0)
+        gcStep(true);
+    else
+        gc();
+}
+
+/*
+ * A full GC cycle: startGcCycle shades the roots, markSlice drains the mark stack, remark rescans the thread
+ * stacks and the objects allocated since the cycle started, and sweepSlice frees what is left unmarked.
+ * Between slices the write barriers shade every object stored while marking, so a scanned object never
+ * ends up referencing an unmarked one. The caller holds flintLock, heapLock and execLock
+ */
+void Flint::startGcCycle(void) {
+    /* A full GC traces the old objects itself */
+    rememberedCount = 0;
+    promotedBytes = 0;
+    loaders.forEach([](ClassLoader *ld) { ld->youngStatics = false; });
+    execs.forEach([this](FExec *exec) {
+        takeNewObjects(exec);
+        exec->lastRemembered = NULL;
+    });
+    youngObjs.forEach([this](JObject *obj) { objs.add(obj); });
+    globalObjs.forEach([this](JObject *obj) { shade(obj); });
+    loaders.forEach([this](ClassLoader *ld) { markStaticFields(ld); });
+    execs.forEach([this](FExec *exec) { markExecution(exec, &objs); });
+    sweepTotalBytes = 0;
+    sweepSurvivedBytes = 0;
+    sweepFreedObjects = 0;
+    gcPhase = GC_MARKING;
+}
+
+/* Returns false if deadline passed before the mark stack was empty */
+bool Flint::markSlice(int64_t deadline) {
+    uint32_t count = 0;
+    while(markStackTop > 0) {
+        if((++count & 0x1F) == 0 && FlintAPI::System::getTimeNanos() >= deadline) return false;
+        JObject *obj = markStack[--markStackTop];
+        forEachReference(obj, [this](JObject *ref) { shade(ref); });
+    }
+    return true;
+}
+
+void Flint::remark(void) {
+    /* Stack slots are written without a barrier, and objects allocated during the cycle are not swept */
+    execs.forEach([this](FExec *exec) {
+        markExecution(exec, &objs);
+        exec->allocLock.lock();
+        exec->newObjs.forEach([this](JObject *obj) { markChildren(obj); });
+        exec->allocLock.unlock();
+    });
+    youngObjs.forEach([this](JObject *obj) { markChildren(obj); });
+    finishMark();
+    sweepCursor = (JObject *)objs.root;
+    gcPhase = GC_SWEEPING;
+}
+
+/* Returns false if deadline passed before the end of objs */
+bool Flint::sweepSlice(int64_t deadline) {
+    uint32_t count = 0;
+    while(sweepCursor != NULL) {
+        if((++count & 0x1F) == 0 && FlintAPI::System::getTimeNanos() >= deadline) return false;
+        JObject *obj = sweepCursor;
+        sweepCursor = (JObject *)obj->next;
+        uint32_t objSize = sizeof(JObject) + obj->size;
+        uint8_t prot = obj->getProtected();
+        sweepTotalBytes += objSize;
+        /* Free object if it is not marked */
+        if(prot == 0) {
+            sweepFreedObjects++;
+            freeObject(obj);
+        }
+        else {
+            sweepSurvivedBytes += objSize;
+            if(!(prot & 0x02)) obj->clearProtected();
         }
     }
+    return true;
 }
 
-bool Flint::isObject(void *p) {
-    if(!isHeapPointer(p)) return false;
-    JObject *obj = (JObject *)p;
-    return objs.isContain(obj) || globalObjs.isContain(obj);
+void Flint::finishGcCycle(void) {
+    globalObjs.forEach([this](JObject *obj) {
+        sweepTotalBytes += sizeof(JObject) + obj->size;
+        sweepSurvivedBytes += sizeof(JObject) + obj->size;
+        obj->clearProtected();
+    });
+    auto clearMarked = [](JObject *obj) { if(obj->getProtected() == 0x01) obj->clearProtected(); };
+    execs.forEach([&clearMarked](FExec *exec) {
+        exec->allocLock.lock();
+        exec->newObjs.forEach(clearMarked);
+        exec->allocLock.unlock();
+    });
+    youngObjs.forEach(clearMarked);
+    updateGcThreshold(sweepSurvivedBytes, sweepTotalBytes);
+    gcStats.fullCount++;
+    recordCollection(sweepTotalBytes - sweepSurvivedBytes, sweepFreedObjects);
+    gcPhase = GC_IDLE;
+}
+
+/* Advances the cycle in progress until deadline, returns true once it is finished */
+bool Flint::gcSlice(int64_t deadline) {
+    if(gcPhase == GC_MARKING) {
+        if(!markSlice(deadline)) return false;
+        remark();
+    }
+    if(!sweepSlice(deadline)) return false;
+    finishGcCycle();
+    return true;
+}
+
+/* One slice of at most GC_PAUSE_BUDGET_US, a new cycle is started only if start is set */
+void Flint::gcStep(bool start) {
+    lock();
+    heapLock.lock();
+    execLock.lock();
+    if(gcPhase != GC_IDLE || start) {
+        int64_t startTime = FlintAPI::System::getTimeNanos();
+        int64_t deadline = startTime + GC_PAUSE_BUDGET_US * 1000LL;
+        if(gcPhase == GC_IDLE) startGcCycle();
+        gcSlice(deadline);
+        nextGcStep = allocatedBytes + GC_STEP_SIZE;
+        recordPause(startTime);
+    }
+    execLock.unlock();
+    heapLock.unlock();
+    unlock();
 }
 
 void Flint::gc(void) {
     lock();
-    objectCountToGc = 0;
-    globalObjs.forEach([this](JObject *obj) {
-        markObjectRecursion(obj);
+    heapLock.lock();
+    execLock.lock();
+    int64_t startTime = FlintAPI::System::getTimeNanos();
+    /* Finish the incremental cycle in progress, then collect what became garbage since it started */
+    if(gcPhase != GC_IDLE) gcSlice(INT64_MAX);
+    startGcCycle();
+    gcSlice(INT64_MAX);
+    recordPause(startTime);
+    execLock.unlock();
+    heapLock.unlock();
+    unlock();
+}
+
+/* The caller holds heapLock */
+void Flint::recordPause(int64_t startTime) {
+    uint32_t pauseUs = (uint32_t)((FlintAPI::System::getTimeNanos() - startTime) / 1000);
+    gcStats.pauseCount++;
+    gcStats.lastPauseUs = pauseUs;
+    gcStats.totalPauseUs += pauseUs;
+    if(pauseUs > gcStats.maxPauseUs) gcStats.maxPauseUs = pauseUs;
+}
+
+/* The caller holds heapLock */
+void Flint::recordCollection(uint32_t freedBytes, uint32_t freedObjects) {
+    int64_t now = FlintAPI::System::getTimeNanos();
+    gcStats.lastFreedBytes = freedBytes;
+    gcStats.lastFreedObjects = freedObjects;
+    gcStats.totalFreedBytes += freedBytes;
+    gcStats.totalFreedObjects += freedObjects;
+    if(lastCollectionTime != 0 && now > lastCollectionTime) {
+        uint64_t allocated = gcStats.totalAllocatedBytes - lastCollectionAllocated;
+        uint64_t rate = allocated * 1000000000ULL / (uint64_t)(now - lastCollectionTime);
+        gcStats.allocationRate = (rate > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)rate;
+    }
+    lastCollectionTime = now;
+    lastCollectionAllocated = gcStats.totalAllocatedBytes;
+}
+
+void Flint::getGcStats(GcStats *stats) {
+    heapLock.lock();
+    *stats = gcStats;
+    stats->liveBytes = liveBytes + promotedBytes;
+    stats->usedBytes = liveBytes + promotedBytes + allocatedBytes;
+    stats->gcThreshold = gcThreshold;
+    stats->heapBlocks = heapCount;
+    heapLock.unlock();
+}
+
+/*
+ * Writes every object, its class and the objects it references, then the roots, to a file in the format
+ * described in flint_heap_dump.h. Records go out through a fixed buffer so the dump needs no heap memory.
+ * Threads are not stopped, a thread that runs meanwhile may leave its stack roots slightly out of date
+ */
+bool Flint::dumpHeap(const char *path) {
+    HeapDumpWriter writer;
+    if(!writer.open(path)) return false;
+    writer.write("FHPD", 4);
+    writer.writeUInt16(HEAP_DUMP_VERSION);
+    writer.writeUInt16(sizeof(JObject *));
+    lock();
+    heapLock.lock();
+    forEachObject([this, &writer](JObject *obj) {
+        if(obj->type == NULL) {
+            const char *name = ((JClass *)obj)->getTypeName();
+            uint16_t length = strlen(name);
+            writer.writeUInt8(HEAP_DUMP_CLASS);
+            writer.writeUInt32((uint32_t)obj);
+            writer.writeUInt16(length);
+            writer.write(name, length);
+        }
+        writer.writeUInt8(HEAP_DUMP_OBJECT);
+        writer.writeUInt32((uint32_t)obj);
+        writer.writeUInt32((uint32_t)obj->type);
+        writer.writeUInt32(sizeof(JObject) + obj->size);
+        forEachReference(obj, [&writer](JObject *ref) { writer.writeUInt32((uint32_t)ref); });
+        writer.writeUInt32(0);
     });
-    loaders.forEach([this](ClassLoader *ld) {
-        uint16_t objCount = ld->hasStaticObjField();
+    globalObjs.forEach([&writer](JObject *obj) {
+        writer.writeUInt8(HEAP_DUMP_ROOT_GLOBAL);
+        writer.writeUInt32((uint32_t)obj);
+    });
+    loaders.forEach([&writer](ClassLoader *loader) {
+        uint16_t objCount = loader->hasStaticObjField();
+        if(objCount == 0) return;
+        const char *name = loader->getName();
+        uint16_t length = strlen(name);
+        writer.writeUInt8(HEAP_DUMP_ROOT_STATIC);
+        writer.writeUInt16(length);
+        writer.write(name, length);
         for(uint16_t i = 0; objCount > 0; i++) {
-            FieldValue *fieldValue = ld->getStaticFieldByIndex(i);
-            const FieldInfo *fieldInfo = fieldValue->getFieldInfo();
-            if(fieldInfo != NULL && (fieldInfo->desc[0] == 'L' || fieldInfo->desc[0] == '[')) {
-                JObject *obj = fieldValue->getObj();
+            const FieldInfo *fieldInfo = loader->getFieldInfo(i);
+            if((fieldInfo->accessFlag & FIELD_STATIC) && (fieldInfo->desc[0] == 'L' || fieldInfo->desc[0] == '[')) {
+                JObject *obj = loader->getStaticFieldByIndex(fieldInfo->getSlot())->getObj();
                 objCount--;
-                if(obj && (obj->getProtected() & 0x01) == 0)
-                    markObjectRecursion(obj);
+                if(obj) writer.writeUInt32((uint32_t)obj);
             }
         }
+        writer.writeUInt32(0);
     });
-    execs.forEach([this](FExec *exec) {
-        if(exec->ownerThread && (exec->ownerThread->getProtected() & 0x01) == 0)
-            markObjectRecursion(exec->ownerThread);
-        if(exec->excp != NULL && ((uint32_t)exec->excp & 0x01) != 0 && (exec->excp->getProtected() & 0x01) == 0)
-            markObjectRecursion(exec->excp);
-        int32_t startSp = exec->startSp;
-        int32_t endSp = (exec->sp > exec->peakSp) ? exec->sp : exec->peakSp;
-        while(startSp >= 3) {
-            for(int32_t i = startSp; i <= endSp; i++) {
-                JObject *obj = (JObject *)exec->stack[i];
-                if(isHeapPointer(obj) && objs.isContain(obj)) {
-                    if(obj && (obj->getProtected() & 0x01) == 0)
-                        markObjectRecursion(obj);
-                }
+    execLock.lock();
+    execs.forEach([this, &writer](FExec *exec) {
+        uint32_t threadId = (uint32_t)exec->ownerThread;
+        if(exec->excp != NULL && ((uint32_t)exec->excp & 0x01) == 0) {
+            writer.writeUInt8(HEAP_DUMP_ROOT_THREAD);
+            writer.writeUInt32(threadId);
+            writer.writeUInt32((uint32_t)exec->excp);
+        }
+        /* Stack slots are not typed, every word that points to an object is written as a root */
+        for(int32_t i = 0; i <= exec->sp; i++) {
+            JObject *obj = (JObject *)exec->stack[i];
+            if(isObject(obj)) {
+                writer.writeUInt8(HEAP_DUMP_ROOT_THREAD);
+                writer.writeUInt32(threadId);
+                writer.writeUInt32((uint32_t)obj);
             }
-            endSp = startSp - 4;
-            startSp = exec->stack[startSp];
         }
     });
-    objs.forEach([this](JObject *obj) {
-        uint8_t prot = obj->getProtected();
-        /* Free object if it is not marked */
-        if(prot == 0) freeObject(obj);
-        else if(!(prot & 0x02)) obj->clearProtected();
-    });
+    execLock.unlock();
+    heapLock.unlock();
     unlock();
+    writer.writeUInt8(HEAP_DUMP_END);
+    return writer.close();
+}
+
+/* Dumps the heap on the first OutOfMemoryError since the last reset, so the file shows what filled it */
+void Flint::dumpHeapOnOom(void) {
+    if(!HEAP_DUMP_ON_OOM || heapDumped) return;
+    heapDumped = true;
+    dumpHeap(HEAP_DUMP_FILE_NAME);
 }
 
 typedef struct {
@@ -1034,8 +1890,9 @@ char *getNextValue(char *value, char seperator, uint32_t *len) {
 static bool readManifest(Flint *flint, const char *jarPath, Manifest *manifest) {
     bool ret = false;
     char buff[FILE_NAME_BUFF_SIZE];
-    ZipFileReader zip(NULL, jarPath);
-    if(!zip.open()) return false;
+    ZipFileReader zip(flint, NULL, jarPath);
+    flint->lock();
+    if(!zip.open()) { flint->unlock(); return false; }
     if(!zip.gotoFile("META-INF/MANIFEST.MF")) goto exit;
     while(true) {
         int32_t br = zip.readLine(buff, sizeof(buff));
@@ -1054,6 +1911,7 @@ static bool readManifest(Flint *flint, const char *jarPath, Manifest *manifest)
     ret = true;
 exit:
     zip.close();
+    flint->unlock();
     return ret;
 }
 
@@ -1099,19 +1957,19 @@ bool Flint::isRunning(void) {
 }
 
 void Flint::stopRequest(void) {
-    lock();
+    execLock.lock();
     execs.forEach([](FExec *exec) {
         exec->stopRequest();
     });
-    unlock();
+    execLock.unlock();
 }
 
 void Flint::terminateRequest(void) {
-    lock();
+    execLock.lock();
     execs.forEach([](FExec *exec) {
         exec->terminateRequest();
     });
-    unlock();
+    execLock.unlock();
 }
 
 void Flint::terminate(void) {
@@ -1122,51 +1980,90 @@ void Flint::terminate(void) {
 }
 
 void Flint::freeObject(JObject *obj) {
-    lock();
-    if(objs.isContain(obj)) objs.remove(obj);
-    else globalObjs.remove(obj);
-    unlock();
-    obj->destroy(this);
+    if(rememberedCount > 0) {
+        heapLock.lock();
+        forget(obj);
+        heapLock.unlock();
+    }
+    detachObject(obj);
+    freeMonitor(&obj->monitor);
     Flint::free(obj);
 }
 
 void Flint::freeAllObject(void) {
     lock();
-    shutdownHook.forEach([this](Hook *hook) { hook->invoke(); Flint::free(hook); });
+    heapLock.lock();
+    ListNode *hook = shutdownHook.root;
     shutdownHook.clear();
+    heapLock.unlock();
+    /* A hook may allocate and so run the GC, the list is detached and they run without heapLock */
+    while(hook != NULL) {
+        ListNode *next = hook->next;
+        hook->ownerList = NULL;
+        ((Hook *)hook)->invoke();
+        Flint::free(hook);
+        hook = next;
+    }
+    heapLock.lock();
+    execLock.lock();
+    execs.forEach([this](FExec *exec) { takeNewObjects(exec); });
+    execLock.unlock();
+    youngObjs.forEach([this](JObject *obj) { objs.add(obj); });
     classes.forEach([this](JClassDictNode *item) { Flint::free(item); });
     classes.clear();
     constStr.forEach([this](JStringDictNode *item) { Flint::free(item); });
     constStr.clear();
-    objs.forEach([this](JObject *obj) { obj->ownerList = NULL; obj->destroy(this); Flint::free(obj); });
+    objs.forEach([this](JObject *obj) { obj->ownerList = NULL; freeMonitor(&obj->monitor); Flint::free(obj); });
     objs.clear();
-    globalObjs.forEach([this](JObject *obj) { obj->ownerList = NULL; obj->destroy(this); Flint::free(obj); });
+    globalObjs.forEach([this](JObject *obj) { obj->ownerList = NULL; freeMonitor(&obj->monitor); Flint::free(obj); });
     globalObjs.clear();
-    objectCountToGc = 0;
+    allocatedBytes = 0;
+    gcThreshold = GC_MIN_THRESHOLD;
+    liveBytes = 0;
+    promotedBytes = 0;
+    rememberedCount = 0;
+    gcPhase = GC_IDLE;
+    sweepCursor = NULL;
+    nextGcStep = 0;
+    memset(&gcStats, 0, sizeof(gcStats));
+    lastCollectionTime = 0;
+    lastCollectionAllocated = 0;
+    heapDumped = false;
+    heapLock.unlock();
     unlock();
 }
 
 void Flint::clearAllStaticFields(void) {
-    loaders.forEach([](ClassLoader *item) {
-        item->monitorOwnId = 0;
+    loaders.forEach([this](ClassLoader *item) {
+        freeMonitor(&item->monitor);
         item->clearStaticFields();
+        item->clearConstFieldValues();
     });
 }
 
 void Flint::freeAllExecution(void) {
-    lock();
-    execs.forEach([this](FExec *exec) { execs.remove(exec); Flint::free(exec); });
+    execLock.lock();
+    ListNode *node = execs.root;
     execs.clear();
-    unlock();
+    execLock.unlock();
+    while(node != NULL) {
+        ListNode *next = node->next;
+        node->ownerList = NULL;
+        releaseTlab((FExec *)node);
+        Flint::free(node);
+        node = next;
+    }
 }
 
 void Flint::freeAllClassLoader(void) {
     lock();
     loaders.forEach([this](ClassLoader *item) {
+        freeMonitor(&item->monitor);
         item->~ClassLoader();
         Flint::free(item);
     });
     loaders.clear();
+    interfaceIdCount = 0;
     classOfClass = NULL;
     classOfObject = NULL;
     classOfCloneable = NULL;
@@ -1181,11 +2078,30 @@ void Flint::freeAllConstUtf8(void) {
     unlock();
 }
 
+void Flint::freeAllZipIndex(void) {
+    lock();
+    zipIndexes.forEach([this](ZipIndex *item) { Flint::free(item); });
+    zipIndexes.clear();
+    unlock();
+}
+
+void Flint::freeAllFileHandle(void) {
+    lock();
+    files.forEach([this](FileDictNode *item) {
+        FlintAPI::IO::fclose(item->getHandle());
+        Flint::free(item);
+    });
+    files.clear();
+    unlock();
+}
+
 void Flint::freeAll(void) {
     freeAllObject();
     freeAllExecution();
     freeAllClassLoader();
     freeAllConstUtf8();
+    freeAllZipIndex();
+    freeAllFileHandle();
 }
 
 void Flint::reset(void) {
@@ -1208,107 +2124,102 @@ Hook *Flint::addShutdownHook(FExec *ctx, void *handle, void (*func)(void *)) {
     Hook *hook = (Hook *)Flint::malloc(ctx, sizeof(Hook));
     if(hook == NULL) return NULL;
     new (hook)Hook(handle, func);
-    lock();
+    heapLock.lock();
     shutdownHook.add(hook);
-    unlock();
+    heapLock.unlock();
     return hook;
 }
 
 bool Flint::removeShutdownHook(Hook *hook) {
-    lock();
+    heapLock.lock();
     shutdownHook.remove(hook);
-    unlock();
+    heapLock.unlock();
     return false;
 }
 
 void Flint::wait(FExec *ctx, JObject *obj, int64_t millis) {
-    int64_t startTime = FlintAPI::System::getTimeMillis();
     if(ctx == NULL) return;
-    jthread ownerThread = ctx->getOwnerThread();
-    uint32_t notifyValue;
-
-    if(obj->monitorCount == 0 || obj->ownId != (uint32_t)ctx) {
+    LockWord *lock = &obj->monitor;
+    if(lock->getOwner() != ctx) {
         ctx->throwNew(findClass(ctx, "java/lang/IllegalMonitorStateException"), "current thread is not owner");
         return;
     }
+    Monitor *mon = inflateMonitor(ctx, lock);
+    if(mon == NULL) return;
 
+    jthread ownerThread = ctx->getOwnerThread();
+    uint32_t countOld = lock->count;
+    monitorLock.lock();
+    lock->count = 0;
+    mon->owner = NULL;
+    Monitor::enqueue(&mon->waitSet, ctx);
+    if(mon->entryQueue != NULL)
+        unparkExec(mon->entryQueue);
+    monitorLock.unlock();
     ctx->setCurrentWaiting(obj);
-    uint32_t monitorCountOld = obj->monitorCount;
-    obj->monitorCount = 0;
-    obj->ownId = 0;
 
-    if(millis > 0) {
-        while((int64_t)(FlintAPI::System::getTimeMillis() - startTime) < millis) {
+    /* notify takes us off the wait set before unparking, so still being on it means the wake-up was not a notification */
+    int64_t startTime = FlintAPI::System::getTimeMillis();
+    while(!ctx->hasTerminateRequest() && !ownerThread->getInterrupt()) {
+        uint32_t timeout = 0;
+        if(millis > 0) {
             int64_t remaining = millis - (FlintAPI::System::getTimeMillis() - startTime);
-            if(remaining > 1000) remaining = 1000;
-            else if(remaining < 0) break;
-            if(ctx->hasTerminateRequest() || ownerThread->getInterrupt()) break;
-            if((FlintAPI::Thread::wait((uint32_t)remaining, &notifyValue) == true) && (notifyValue == (uint32_t)obj)) break;
-        }
-    }
-    else {
-        while(true) {
-            if(ctx->hasTerminateRequest() || ownerThread->getInterrupt()) break;
-            if((FlintAPI::Thread::wait(0, &notifyValue) == true) && (notifyValue == (uint32_t)obj)) break;
+            if(remaining <= 0) break;
+            timeout = (remaining > 1000) ? 1000 : (uint32_t)remaining;
         }
+        FlintAPI::Thread::park(timeout);
+        bool waiting = false;
+        monitorLock.lock();
+        for(FExec *exec = mon->waitSet; exec != NULL && !waiting; exec = exec->monitorNext)
+            waiting = (exec == ctx);
+        monitorLock.unlock();
+        if(!waiting) break;
     }
+    monitorLock.lock();
+    Monitor::remove(&mon->waitSet, ctx);
+    monitorLock.unlock();
+    ctx->setCurrentWaiting(NULL);
 
-    volatile uint32_t *monitorCount = &obj->monitorCount;
-    if(!ctx->hasTerminateRequest()) {
-        while(!ctx->hasTerminateRequest()) {
-            if(*monitorCount == 0) {
-                lock();
-                if(*monitorCount == 0) {
-                    obj->monitorCount = monitorCountOld;
-                    obj->ownId = (uint32_t)ctx;
-                    unlock();
-                    break;
-                }
-                unlock();
-            }
-            FlintAPI::Thread::yield();
-        }
-        if(!ctx->hasTerminateRequest() && ownerThread->getInterrupt()) {
-            ctx->throwNew(findClass(ctx, "java/lang/InterruptedException"), "wait interrupted");
-            ownerThread->clearInterrupt();
-        }
+    if(!monitorEnter(ctx, lock)) return;
+    lock->count = countOld;
+    if(ownerThread->getInterrupt()) {
+        ctx->throwNew(findClass(ctx, "java/lang/InterruptedException"), "wait interrupted");
+        ownerThread->clearInterrupt();
     }
-    ctx->setCurrentWaiting(NULL);
 }
 
 void Flint::notify(FExec *ctx, JObject *obj) {
     if(ctx == NULL) return;
-    if(obj->monitorCount == 0 || obj->ownId != (uint32_t)ctx) {
+    if(obj->monitor.getOwner() != ctx) {
         ctx->throwNew(findClass(ctx, "java/lang/IllegalMonitorStateException"), "current thread is not owner");
         return;
     }
-
-    lock();
-    for(ListNode *node = execs.root; node != NULL;) {
-        ListNode *nextNode = node->next;
-        if(((FExec *)node)->getCurrentWaiting() == obj) {
-            FlintAPI::Thread::notify(((FExec *)node)->getOwnerThread()->getHandle(), (uint32_t)obj);
-            break;
-        }
-        node = nextNode;
+    Monitor *mon = obj->monitor.getMonitor();
+    if(mon == NULL) return; /* Never waited on */
+
+    monitorLock.lock();
+    FExec *waiter = mon->waitSet;
+    if(waiter != NULL) {
+        Monitor::remove(&mon->waitSet, waiter);
+        unparkExec(waiter);
     }
-    unlock();
+    monitorLock.unlock();
 }
 
 void Flint::notifyAll(FExec *ctx, JObject *obj) {
     if(ctx == NULL) return;
-    if(obj->monitorCount == 0 || obj->ownId != (uint32_t)ctx) {
-        if(ctx != NULL)
-            ctx->throwNew(findClass(ctx, "java/lang/IllegalMonitorStateException"), "current thread is not owner");
+    if(obj->monitor.getOwner() != ctx) {
+        ctx->throwNew(findClass(ctx, "java/lang/IllegalMonitorStateException"), "current thread is not owner");
         return;
     }
-
-    lock();
-    for(ListNode *node = execs.root; node != NULL;) {
-        ListNode *nextNode = node->next;
-        if(((FExec *)node)->getCurrentWaiting() == obj)
-            FlintAPI::Thread::notify(((FExec *)node)->getOwnerThread()->getHandle(), (uint32_t)obj);
-        node = nextNode;
+    Monitor *mon = obj->monitor.getMonitor();
+    if(mon == NULL) return;
+
+    monitorLock.lock();
+    while(mon->waitSet != NULL) {
+        FExec *waiter = mon->waitSet;
+        Monitor::remove(&mon->waitSet, waiter);
+        unparkExec(waiter);
     }
-    unlock();
+    monitorLock.unlock();
 }
@@ -6,11 +6,14 @@
 #include "flint_common.h"
 #include "flint_default_conf.h"
 #include "flint_class_loader.h"
+#include "flint_stack_map.h"
 #include "flint_zip_file_reader.h"
 
 #define FLAG_HAS_STATIC_FIELD   0x01
 #define FLAG_HAS_CLINIT         0x02
+#define FLAG_LINKED             0x04
 #define FLAG_STATIC_INIT        0x08
+#define FLAG_LAYOUT             0x10
 
 typedef struct {
     ConstPoolTag tag;
@@ -23,14 +26,14 @@ static bool FindInZip(Flint *flint, FExec *ctx, const char *clsName, uint16_t le
 
     const char *jar = flint->getProgram();
     if(jar != NULL) {
-        new (zip)ZipFileReader(ctx, jar);
+        new (zip)ZipFileReader(flint, ctx, jar);
         if(zip->open()) {
             if(zip->gotoClassFile(clsName, length)) return true;
             zip->close();
         }
     }
     while((jar = flint->getClassPath(index++)) != NULL) {
-        new (zip)ZipFileReader(ctx, jar);
+        new (zip)ZipFileReader(flint, ctx, jar);
         if(zip->open()) {
             if(zip->gotoClassFile(clsName, length)) return true;
             zip->close();
@@ -40,6 +43,112 @@ static bool FindInZip(Flint *flint, FExec *ctx, const char *clsName, uint16_t le
     return false;
 }
 
+static void toNativeInt16(uint8_t *p) {
+    int16_t value = (int16_t)((p[0] << 8) | p[1]);
+    memcpy(p, &value, sizeof(value));
+}
+
+static void toNativeInt32(uint8_t *p) {
+    int32_t value = (int32_t)((p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+    memcpy(p, &value, sizeof(value));
+}
+
+static int32_t readNativeInt32(const uint8_t *p) {
+    int32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/*
+ * The interpreter binary searches the match-offset pairs, so they have to be sorted by key. javac always sorts them and
+ * the verifier requires it, they are only sorted here when a class file gets it wrong. When the keys turn out to be
+ * consecutive the pair index is simply key - first key and the instruction is marked as OP_LOOKUPSWITCH_DENSE
+ */
+static void lowerLookupSwitch(uint8_t *code, uint32_t pc) {
+    uint8_t *pairs = &code[((pc + 4) & ~0x03) + 8];
+    int32_t npairs = readNativeInt32(&pairs[-4]);
+    for(int32_t i = 1; i < npairs; i++) {
+        uint8_t pair[8];
+        memcpy(pair, &pairs[i * 8], sizeof(pair));
+        int32_t key = readNativeInt32(pair);
+        int32_t j = i;
+        for(; j > 0 && readNativeInt32(&pairs[(j - 1) * 8]) > key; j--)
+            memcpy(&pairs[j * 8], &pairs[(j - 1) * 8], sizeof(pair));
+        if(j != i) memcpy(&pairs[j * 8], pair, sizeof(pair));
+    }
+    if(npairs <= 0) return;
+    uint32_t first = (uint32_t)readNativeInt32(pairs);
+    uint32_t last = (uint32_t)readNativeInt32(&pairs[(npairs - 1) * 8]);
+    if(last - first == (uint32_t)(npairs - 1))
+        code[pc] = OP_LOOKUPSWITCH_DENSE;
+}
+
+/*
+ * Branch offsets, sipush immediates and switch tables are big endian in the class file. They are rewritten in place
+ * to native byte order so the interpreter reads them with a plain load. Runs last, everything before it reads the
+ * code as it is in the class file (GetInstructionLength included)
+ */
+static void predecodeOperands(uint8_t *code, uint32_t codeLength) {
+    for(uint32_t pc = 0; pc < codeLength;) {
+        uint32_t length = GetInstructionLength(code, pc);
+        uint8_t opcode = code[pc];
+        if(opcode == OP_SIPUSH || (opcode >= OP_IFEQ && opcode <= OP_JSR) || opcode == OP_IFNULL_PTR || opcode == OP_IFNONNULL_PTR)
+            toNativeInt16(&code[pc + 1]);
+        else if(opcode == OP_GOTO_W || opcode == OP_JSRW)
+            toNativeInt32(&code[pc + 1]);
+        else if(opcode == OP_TABLESWITCH || opcode == OP_LOOKUPSWITCH) {
+            for(uint32_t i = (pc + 4) & ~0x03; i < pc + length; i += 4)
+                toNativeInt32(&code[i]);
+            if(opcode == OP_LOOKUPSWITCH) lowerLookupSwitch(code, pc);
+        }
+        pc += length;
+    }
+}
+
+static bool isIntLoad(uint8_t opcode) {
+    return (opcode == OP_ILOAD) || (opcode >= OP_ILOAD_0 && opcode <= OP_ILOAD_3);
+}
+
+static bool isObjLoad(uint8_t opcode) {
+    return (opcode == OP_ALOAD) || (opcode >= OP_ALOAD_0 && opcode <= OP_ALOAD_3);
+}
+
+/* Maps iload/aload and iload_<n>/aload_<n> to the superinstruction of the same form */
+static uint8_t fusedLoad(uint8_t opcode, uint8_t load, uint8_t load0, uint8_t fused, uint8_t fused0) {
+    return (opcode == load) ? fused : (uint8_t)(fused0 + (opcode - load0));
+}
+
+/*
+ * Writes a superinstruction over the first opcode of the most common short sequences, the instructions after it are
+ * left as they are. A branch into the middle of a sequence still runs them one by one, and the interpreter falls back
+ * to the first instruction alone when they were changed later (breakpoints, quickening)
+ */
+static void fuseInstructions(uint8_t *code, uint32_t codeLength) {
+    for(uint32_t pc = 0; pc < codeLength;) {
+        uint8_t opcode = code[pc];
+        uint32_t next = pc + GetInstructionLength(code, pc);
+        if(next >= codeLength) break;
+        uint8_t opcode2 = code[next];
+        uint32_t next2 = next + GetInstructionLength(code, next);
+        uint8_t opcode3 = (next2 < codeLength) ? code[next2] : (uint8_t)OP_EXIT;
+        uint8_t fused = OP_UNKNOW;
+        if(opcode == OP_ALOAD_0 && opcode2 == OP_GETFIELD)
+            fused = OP_ALOAD_0_GETFIELD;
+        else if(isObjLoad(opcode) && opcode2 == OP_ARRAYLENGTH)
+            fused = fusedLoad(opcode, OP_ALOAD, OP_ALOAD_0, OP_ALOAD_ARRAYLENGTH, OP_ALOAD_0_ARRAYLENGTH);
+        else if(isIntLoad(opcode) && isIntLoad(opcode2) && opcode3 == OP_IADD)
+            fused = fusedLoad(opcode, OP_ILOAD, OP_ILOAD_0, OP_ILOAD_ILOAD_IADD, OP_ILOAD_0_ILOAD_IADD);
+        else if(isIntLoad(opcode) && ((opcode2 >= OP_ICONST_M1 && opcode2 <= OP_ICONST_5) || opcode2 == OP_BIPUSH) &&
+                opcode3 >= OP_IF_ICMPEQ && opcode3 <= OP_IF_ICMPLE)
+            fused = fusedLoad(opcode, OP_ILOAD, OP_ILOAD_0, OP_ILOAD_ICONST_IF_ICMP, OP_ILOAD_0_ICONST_IF_ICMP);
+        else if(opcode == OP_IINC && opcode2 == OP_GOTO)
+            fused = OP_IINC_GOTO;
+        /* No sequence can start at the second or third instruction of another one, so they never overlap */
+        if(fused != OP_UNKNOW) code[pc] = fused;
+        pc = next;
+    }
+}
+
 static bool dumpAttribute(FileReader *reader) {
     if(!reader->offset(2)) return false; /* nameIndex */
     uint32_t length;
@@ -58,9 +167,14 @@ ClassLoader::ClassLoader(Flint *flint) : DictNode(), flint(flint) {
     methodsCount = 0;
     nestHost = 0;
     nestMembersCount = 0;
+    vtableLength = 0;
+    itablesCount = 0;
+    instanceSlotCount = 0;
+    instanceObjCount = 0;
+    superDepth = 0;
+    interfaceId = 0;
+    interfaceSetWords = 0;
     hash = 0;
-    monitorOwnId = 0;
-    monitorCount = 0;
     poolTable = NULL;
     interfaces = NULL;
     fields = NULL;
@@ -68,6 +182,13 @@ ClassLoader::ClassLoader(Flint *flint) : DictNode(), flint(flint) {
     nestMembers = NULL;
     staticFields = NULL;
     filePath = NULL;
+    vtable = NULL;
+    itables = NULL;
+    superLoader = NULL;
+    instanceRefMap = NULL;
+    superDisplay = NULL;
+    interfaceSet = NULL;
+    youngStatics = false;
 }
 
 uint32_t ClassLoader::getHashKey(void) const {
@@ -87,6 +208,8 @@ bool ClassLoader::load(FileReader *reader) {
     char *utf8Buff = buff;
     uint16_t utf8Length = sizeof(buff);
     FExec *ctx = reader->getContext();
+    /* Inflated data can only be read forwards, so method code can not be loaded lazily from a compressed entry */
+    bool lazyCode = !reader->isCompressed();
     this->filePath = reader->getFilePath();
     /* if(!FReadSwapUInt32(reader, magic)) return false; */         /* magic = */
     /* if(!FReadSwapUInt16(reader, minorVersion)) return false; */  /* minorVersion = */
@@ -190,6 +313,7 @@ bool ClassLoader::load(FileReader *reader) {
     if(!reader->readSwapUInt16(fieldsCount)) return false;
     if(fieldsCount) {
         uint32_t loadedCount = 0;
+        uint16_t staticSlot = 0;
         fields = (FieldInfo *)flint->malloc(ctx, fieldsCount * sizeof(FieldInfo));
         if(fields == NULL) return false;
         for(uint16_t i = 0; i < fieldsCount; i++) {
@@ -215,9 +339,12 @@ bool ClassLoader::load(FileReader *reader) {
                 const char *fieldName = getConstUtf8(fieldsNameIndex);
                 const char *fieldDesc = getConstUtf8(fieldsDescIndex);
                 new (&fields[loadedCount])FieldInfo((FieldAccessFlag)flag, fieldName, fieldDesc);
-                loadedCount++;
-                if(flag & FIELD_STATIC)
+                if(flag & FIELD_STATIC) {
                     loaderFlags |= FLAG_HAS_STATIC_FIELD;
+                    fields[loadedCount].slot = staticSlot;
+                    staticSlot += (fieldDesc[0] == 'J' || fieldDesc[0] == 'D') ? 2 : 1;
+                }
+                loadedCount++;
             }
         }
         if(loadedCount == 0) {
@@ -243,7 +370,8 @@ bool ClassLoader::load(FileReader *reader) {
             if(!reader->readSwapUInt16(methodDescIndex)) return false;
             if(!reader->readSwapUInt16(methodAttributesCount)) return false;
             if(!(flag & METHOD_NATIVE)) {
-                flag |= METHOD_UNLOADED;
+                if(!(flag & METHOD_ABSTRACT))
+                    flag |= METHOD_UNLOADED;
                 if((flag & METHOD_STATIC) && strcmp(getConstUtf8(methodNameIndex), "<clinit>") == 0) {
                     flag = (flag | METHOD_CLINIT);
                     loaderFlags |= FLAG_HAS_CLINIT;
@@ -254,13 +382,25 @@ bool ClassLoader::load(FileReader *reader) {
             const char *methodName = getConstUtf8(methodNameIndex);
             const char *methodDesc = getConstUtf8(methodDescIndex);
             new (&methods[i])MethodInfo(this, (MethodAccessFlag)flag, methodName, methodDesc);
+            if((accessFlags & CLASS_INTERFACE) && !(flag & (METHOD_STATIC | METHOD_PRIVATE)))
+                methods[i].tableIndex = i;
             while(methodAttributesCount--) {
                 uint16_t attrNameIdx;
                 uint32_t length;
                 if(!reader->readSwapUInt16(attrNameIdx)) return false;
                 if(!reader->readSwapUInt32(length)) return false;
-                if(strcmp(getConstUtf8(attrNameIdx), "Code") == 0 && !(flag & METHOD_NATIVE))
-                    methods[i].code = (uint8_t *)reader->tell();
+                if(strcmp(getConstUtf8(attrNameIdx), "Code") == 0 && !(flag & METHOD_NATIVE)) {
+                    if(lazyCode)
+                        methods[i].code = (uint8_t *)reader->tell();
+                    else {
+                        uint32_t attrEnd = reader->tell() + length;
+                        methods[i].code = (uint8_t *)readAttributeCode(reader, &methods[i]);
+                        if(methods[i].code == NULL) return false;
+                        methods[i].accessFlag = (MethodAccessFlag)(methods[i].accessFlag & ~METHOD_UNLOADED);
+                        if(!reader->seek(attrEnd)) return false;
+                        continue;
+                    }
+                }
                 if(!reader->offset(length)) return false;
             }
         }
@@ -302,9 +442,13 @@ ClassLoader *ClassLoader::load(Flint *flint, FExec *ctx, const char *clsName, ui
     if(!reader->open())
         return NULL;
     ClassLoader *loader = (ClassLoader *)flint->malloc(ctx, sizeof(ClassLoader));
-    if(loader == NULL) return NULL;
+    if(loader == NULL) {
+        reader->close();
+        return NULL;
+    }
     new (loader)ClassLoader(flint);
     if(loader->load(reader) == false) {
+        reader->close();
         loader->~ClassLoader();
         flint->free(loader);
         return NULL;
@@ -317,21 +461,29 @@ ClassLoader *ClassLoader::load(Flint *flint, FExec *ctx, const char *clsName, ui
     return loader;
 }
 
-CodeAttribute *ClassLoader::readAttributeCode(FileReader *reader) {
+CodeAttribute *ClassLoader::readAttributeCode(FileReader *reader, MethodInfo *method) {
     uint16_t maxStack, maxLocals;
     uint32_t codeLength;
     if(!reader->readSwapUInt16(maxStack)) return NULL;
     if(!reader->readSwapUInt16(maxLocals)) return NULL;
     if(!reader->readSwapUInt32(codeLength)) return NULL;
-    uint32_t codePos = reader->tell();
-
-    if(!reader->offset(codeLength)) return NULL;
-    uint16_t exceptionTableLength;
-    if(!reader->readSwapUInt16(exceptionTableLength)) return NULL;
 
-    uint32_t codeAttrSize = sizeof(CodeAttribute) + exceptionTableLength * sizeof(ExceptionTable) + codeLength + 1;
+    /* The code is read before the exception table and moved behind it afterwards, the reader never goes back */
+    uint32_t codeAttrSize = sizeof(CodeAttribute) + codeLength + 1;
     CodeAttribute *codeAttr = (CodeAttribute *)flint->malloc(reader->getContext(), codeAttrSize);
     if(codeAttr == NULL) return NULL;
+    if(reader->read(codeAttr->data, codeLength) != codeLength) { flint->free(codeAttr); return NULL; }
+
+    uint16_t exceptionTableLength;
+    if(!reader->readSwapUInt16(exceptionTableLength)) { flint->free(codeAttr); return NULL; }
+    if(exceptionTableLength) {
+        uint32_t tableSize = exceptionTableLength * sizeof(ExceptionTable);
+        CodeAttribute *tmp = (CodeAttribute *)flint->realloc(reader->getContext(), codeAttr, codeAttrSize + tableSize);
+        if(tmp == NULL) { flint->free(codeAttr); return NULL; }
+        codeAttr = tmp;
+        codeAttrSize += tableSize;
+        memmove(&codeAttr->data[tableSize], codeAttr->data, codeLength);
+    }
     codeAttr->maxStack = maxStack;
     codeAttr->maxLocals = maxLocals;
     codeAttr->codeLength = codeLength;
@@ -354,14 +506,54 @@ CodeAttribute *ClassLoader::readAttributeCode(FileReader *reader) {
     while(attrbutesCount--)
         if(!dumpAttribute(reader)) { flint->free(codeAttr); return NULL; }
 
-    if(!reader->seek(codePos)) { flint->free(codeAttr); return NULL; }
     uint8_t *code = (uint8_t *)&((ExceptionTable *)codeAttr->data)[exceptionTableLength];
-    if(reader->read(code, codeLength) != codeLength) { flint->free(codeAttr); return NULL; }
     code[codeLength] = OP_EXIT;
 
+    /*
+     * Each invokevirtual/invokeinterface site gets its own inline cache, appended to the code attribute.
+     * The site is rewritten to the _IC form and its operand becomes the cache index (the pool index moves into the cache)
+     */
+    uint16_t cacheCount = 0;
+    for(uint32_t pc = 0; pc < codeLength; pc += GetInstructionLength(code, pc)) {
+        if(code[pc] == OP_INVOKEVIRTUAL || code[pc] == OP_INVOKEINTERFACE)
+            cacheCount++;
+    }
+    codeAttr->inlineCacheCount = cacheCount;
+    codeAttr->inlineCaches = NULL;
+    if(cacheCount) {
+        uint32_t cacheOffset = (codeAttrSize + 3) & ~0x03;
+        CodeAttribute *tmp = (CodeAttribute *)flint->realloc(reader->getContext(), codeAttr, cacheOffset + cacheCount * sizeof(InlineCache));
+        if(tmp == NULL) { flint->free(codeAttr); return NULL; }
+        codeAttr = tmp;
+        code = (uint8_t *)&((ExceptionTable *)codeAttr->data)[exceptionTableLength];
+        InlineCache *caches = (InlineCache *)((uint8_t *)codeAttr + cacheOffset);
+        memset((void *)caches, 0, cacheCount * sizeof(InlineCache));
+        uint16_t cacheIndex = 0;
+        for(uint32_t pc = 0; pc < codeLength; pc += GetInstructionLength(code, pc)) {
+            if(code[pc] != OP_INVOKEVIRTUAL && code[pc] != OP_INVOKEINTERFACE) continue;
+            caches[cacheIndex].poolIndex = (code[pc + 1] << 8) | code[pc + 2];
+            code[pc] = (code[pc] == OP_INVOKEVIRTUAL) ? OP_INVOKEVIRTUAL_IC : OP_INVOKEINTERFACE_IC;
+            code[pc + 1] = (uint8_t)(cacheIndex >> 8);
+            code[pc + 2] = (uint8_t)cacheIndex;
+            cacheIndex++;
+        }
+        codeAttr->inlineCaches = caches;
+    }
+
+    /* Built after the rewrite above, the _IC sites are looked up through their caches */
+    codeAttr->stackMap = StackMap::build(flint, this, method, codeAttr);
+    fuseInstructions(code, codeLength);
+    predecodeOperands(code, codeLength);
+
     return codeAttr;
 }
 
+void ClassLoader::freeAttributeCode(CodeAttribute *codeAttr) {
+    if(codeAttr->stackMap)
+        flint->free(codeAttr->stackMap);
+    flint->free(codeAttr);
+}
+
 ConstPoolTag ClassLoader::getConstPoolTag(uint16_t poolIndex) const {
     return (ConstPoolTag)(poolTable[poolIndex - 1].tag & 0x7F);
 }
@@ -392,6 +584,29 @@ const char *ClassLoader::getConstClassName(uint16_t poolIndex) const {
     return getConstUtf8(constCls->clsNameIndex);
 }
 
+const char *ClassLoader::getConstMemberDesc(uint16_t poolIndex) const {
+    /* Reads the descriptor of a field/method/invokedynamic entry without resolving it */
+    ConstPool *constPool = &poolTable[poolIndex - 1];
+    switch((uint8_t)constPool->tag) {
+        case CONST_FIELD:
+            return ((ConstField *)constPool->value)->nameAndType->desc;
+        case CONST_METHOD:
+        case CONST_INTERFACE_METHOD:
+            return ((ConstMethod *)constPool->value)->nameAndType->desc;
+        case CONST_FIELD | 0x80:
+        case CONST_METHOD | 0x80:
+        case CONST_INTERFACE_METHOD | 0x80:
+        case CONST_INVOKE_DYNAMIC | 0x80: {
+            ConstPool *nameAndType = &poolTable[((uint16_t *)&constPool->value)[1] - 1];
+            if(nameAndType->tag & 0x80)
+                return getConstUtf8(((uint16_t *)&nameAndType->value)[1]);
+            return ((ConstNameAndType *)nameAndType->value)->desc;
+        }
+        default:
+            return NULL;
+    }
+}
+
 ConstNameAndType *ClassLoader::getConstNameAndType(FExec *ctx, uint16_t poolIndex) {
     poolIndex--;
     if(poolTable[poolIndex].tag & 0x80) {
@@ -529,6 +744,11 @@ JClass *ClassLoader::getConstClass(FExec *ctx, uint16_t poolIndex) {
     return constCls->cls;
 }
 
+JObject *ClassLoader::getConstObject(uint16_t poolIndex) const {
+    /* Only for String/Class entries that are already resolved. ConstClass::cls overlays ConstPool::value */
+    return (JObject *)poolTable[poolIndex - 1].value;
+}
+
 ClassAccessFlag ClassLoader::getAccessFlag(void) const {
     return (ClassAccessFlag)accessFlags;
 }
@@ -586,6 +806,36 @@ FieldInfo *ClassLoader::getFieldInfo(uint16_t fieldIndex) const {
     return &fields[fieldIndex];
 }
 
+FieldInfo *ClassLoader::getFieldInfo(ConstNameAndType *nameAndType, bool isStatic) const {
+    for(uint16_t i = 0; i < fieldsCount; i++) {
+        FieldInfo *fieldInfo = &fields[i];
+        if(
+            ((fieldInfo->accessFlag & FIELD_STATIC) == FIELD_STATIC) == isStatic &&
+            nameAndType->hash == fieldInfo->hash &&
+            strcmp(nameAndType->name, fieldInfo->name) == 0 &&
+            strcmp(nameAndType->desc, fieldInfo->desc) == 0
+        ) {
+            return fieldInfo;
+        }
+    }
+    return NULL;
+}
+
+FieldInfo *ClassLoader::getFieldInfo(const char *name, bool isStatic) const {
+    uint16_t hash = Hash(name);
+    for(uint16_t i = 0; i < fieldsCount; i++) {
+        FieldInfo *fieldInfo = &fields[i];
+        if(
+            ((fieldInfo->accessFlag & FIELD_STATIC) == FIELD_STATIC) == isStatic &&
+            hash == (uint16_t)fieldInfo->hash &&
+            strcmp(name, fieldInfo->name) == 0
+        ) {
+            return fieldInfo;
+        }
+    }
+    return NULL;
+}
+
 uint16_t ClassLoader::getMethodsCount(void) const {
     return methodsCount;
 }
@@ -595,7 +845,7 @@ MethodInfo *ClassLoader::getMethodInfo(FExec *ctx, uint16_t methodIndex) {
     if(method->accessFlag & METHOD_UNLOADED) {
         flint->lock();
         if(method->accessFlag & METHOD_UNLOADED) {
-            FileReader reader(ctx, filePath);
+            FileReader reader(flint, ctx, filePath);
             if(!reader.open()) {
                 flint->unlock();
                 return NULL;
@@ -603,12 +853,12 @@ MethodInfo *ClassLoader::getMethodInfo(FExec *ctx, uint16_t methodIndex) {
 
             if(!reader.seek((uint32_t)method->code)) { reader.close(); flint->unlock(); return NULL; }
 
-            uint8_t *attrCode = (uint8_t *)readAttributeCode(&reader);
+            CodeAttribute *attrCode = readAttributeCode(&reader, method);
             if(attrCode == NULL) { reader.close(); flint->unlock(); return NULL; }
 
-            if(!reader.close()) { flint->free(attrCode); flint->unlock(); return NULL; }
+            if(!reader.close()) { freeAttributeCode(attrCode); flint->unlock(); return NULL; }
 
-            method->code = attrCode;
+            method->code = (uint8_t *)attrCode;
             method->accessFlag = (MethodAccessFlag)(method->accessFlag & ~METHOD_UNLOADED);
         }
         flint->unlock();
@@ -653,6 +903,321 @@ MethodInfo *ClassLoader::getStaticCtor(FExec *ctx) {
     return getMethodInfo(ctx, (ConstNameAndType *)&clinitName);
 }
 
+static bool isVirtualMethod(MethodInfo *method) {
+    return !(method->accessFlag & (METHOD_STATIC | METHOD_PRIVATE | METHOD_INIT | METHOD_CLINIT));
+}
+
+static bool isSameMethod(MethodInfo *method1, MethodInfo *method2) {
+    return (
+        method1->hash == method2->hash &&
+        strcmp(method1->name, method2->name) == 0 &&
+        strcmp(method1->desc, method2->desc) == 0
+    );
+}
+
+MethodInfo *ClassLoader::findVtableMethod(MethodInfo *method) const {
+    for(uint16_t i = 0; i < vtableLength; i++) {
+        if(isSameMethod(vtable[i], method))
+            return vtable[i];
+    }
+    return NULL;
+}
+
+bool ClassLoader::buildVtable(FExec *ctx, ClassLoader *superLoader) {
+    uint16_t length = (superLoader != NULL) ? superLoader->vtableLength : 0;
+    if((length + methodsCount) == 0) return true;
+    vtable = (MethodInfo **)flint->malloc(ctx, (length + methodsCount) * sizeof(MethodInfo *));
+    if(vtable == NULL) return false;
+    if(length > 0)
+        memcpy(vtable, superLoader->vtable, length * sizeof(MethodInfo *));
+    uint16_t superLength = length;
+    for(uint16_t i = 0; i < methodsCount; i++) {
+        MethodInfo *method = &methods[i];
+        if(!isVirtualMethod(method)) continue;
+        uint16_t index = 0;
+        while(index < superLength && !isSameMethod(vtable[index], method))
+            index++;
+        if(index == superLength)
+            index = length++;
+        vtable[index] = method;
+        method->tableIndex = index;
+    }
+    vtableLength = length;
+    if(length == 0) {
+        flint->free(vtable);
+        vtable = NULL;
+    }
+    else if(length != (superLength + methodsCount)) {
+        MethodInfo **tmp = (MethodInfo **)flint->realloc(ctx, vtable, length * sizeof(MethodInfo *));
+        if(tmp == NULL) return false;
+        vtable = tmp;
+    }
+    return true;
+}
+
+static bool addInterface(Flint *flint, FExec *ctx, ClassLoader ***list, uint16_t *count, ClassLoader *loader) {
+    for(uint16_t i = 0; i < *count; i++)
+        if((*list)[i] == loader) return true;
+    ClassLoader **tmp = (ClassLoader **)flint->realloc(ctx, *list, (*count + 1) * sizeof(ClassLoader *));
+    if(tmp == NULL) return false;
+    *list = tmp;
+    tmp[(*count)++] = loader;
+    for(uint16_t i = 0; i < loader->getInterfacesCount(); i++) {
+        JClass *cls = loader->getInterface(ctx, i);
+        if(cls == NULL) return false;
+        if(!addInterface(flint, ctx, list, count, cls->getClassLoader())) return false;
+    }
+    return true;
+}
+
+bool ClassLoader::buildItables(FExec *ctx, ClassLoader *superLoader) {
+    /* Sub-interfaces are collected before their super-interfaces, so the first default method found is the most specific one */
+    ClassLoader **list = NULL;
+    uint16_t count = 0;
+    for(uint16_t i = 0; i < interfacesCount; i++) {
+        JClass *cls = getInterface(ctx, i);
+        if(cls == NULL || !addInterface(flint, ctx, &list, &count, cls->getClassLoader())) {
+            if(list) flint->free(list);
+            return false;
+        }
+    }
+    if(superLoader != NULL) {
+        for(uint16_t i = 0; i < superLoader->itablesCount; i++) {
+            if(!addInterface(flint, ctx, &list, &count, superLoader->itables[i].loader)) {
+                if(list) flint->free(list);
+                return false;
+            }
+        }
+    }
+    if(count == 0) return true;
+    itables = (ITable *)flint->malloc(ctx, count * sizeof(ITable));
+    if(itables == NULL) { flint->free(list); return false; }
+    for(uint16_t i = 0; i < count; i++) {
+        ClassLoader *ifLoader = list[i];
+        itables[i].loader = ifLoader;
+        itables[i].methods = NULL;
+        itablesCount++;
+        if(ifLoader->methodsCount == 0) continue;
+        MethodInfo **table = (MethodInfo **)flint->malloc(ctx, ifLoader->methodsCount * sizeof(MethodInfo *));
+        if(table == NULL) { flint->free(list); return false; }
+        itables[i].methods = table;
+        for(uint16_t j = 0; j < ifLoader->methodsCount; j++) {
+            MethodInfo *ifMethod = &ifLoader->methods[j];
+            if(ifMethod->tableIndex == NON_VIRTUAL_INDEX) { table[j] = NULL; continue; }
+            MethodInfo *impl = findVtableMethod(ifMethod);
+            if(impl == NULL || (impl->accessFlag & METHOD_ABSTRACT)) {
+                MethodInfo *defMethod = NULL;
+                for(uint16_t k = 0; defMethod == NULL && k < count; k++) {
+                    for(uint16_t m = 0; m < list[k]->methodsCount; m++) {
+                        MethodInfo *tmp = &list[k]->methods[m];
+                        if(!(tmp->accessFlag & (METHOD_ABSTRACT | METHOD_STATIC | METHOD_PRIVATE)) && isSameMethod(tmp, ifMethod)) {
+                            defMethod = tmp;
+                            break;
+                        }
+                    }
+                }
+                if(defMethod != NULL) impl = defMethod;
+            }
+            table[j] = (impl != NULL) ? impl : ifMethod;
+        }
+    }
+    flint->free(list);
+    return true;
+}
+
+/*
+ * The super class display lists the classes from java/lang/Object down to this one, so a class is a subclass
+ * of another one at depth d when its display holds that class at index d. Every interface in the itables gets
+ * a small id and the interface set has the bits of those ids. Both make a subtype test a load and a compare
+ */
+bool ClassLoader::buildTypeDisplay(FExec *ctx, ClassLoader *superLoader) {
+    uint16_t depth = (superLoader != NULL) ? (superLoader->superDepth + 1) : 0;
+    ClassLoader **display = (ClassLoader **)flint->malloc(ctx, (depth + 1) * sizeof(ClassLoader *));
+    if(display == NULL) return false;
+    if(depth > 0)
+        memcpy(display, superLoader->superDisplay, depth * sizeof(ClassLoader *));
+    display[depth] = this;
+    superDisplay = display;
+    superDepth = depth;
+
+    uint16_t maxId = 0;
+    for(uint16_t i = 0; i < itablesCount; i++) {
+        ClassLoader *ifLoader = itables[i].loader;
+        if(ifLoader->interfaceId == 0)
+            ifLoader->interfaceId = flint->newInterfaceId();
+        if(ifLoader->interfaceId > maxId)
+            maxId = ifLoader->interfaceId;
+    }
+    if(itablesCount == 0) return true;
+    uint16_t words = maxId / 32 + 1;
+    interfaceSet = (uint32_t *)flint->malloc(ctx, words * sizeof(uint32_t));
+    if(interfaceSet == NULL) return false;
+    memset(interfaceSet, 0, words * sizeof(uint32_t));
+    for(uint16_t i = 0; i < itablesCount; i++) {
+        uint16_t id = itables[i].loader->interfaceId;
+        interfaceSet[id / 32] |= 1U << (id % 32);
+    }
+    interfaceSetWords = words;
+    return true;
+}
+
+bool ClassLoader::isSubclassOf(FExec *ctx, ClassLoader *loader) {
+    if(loader == this) return true;
+    if(!link(ctx)) return false;
+    if(loader->accessFlags & CLASS_INTERFACE) {
+        uint16_t id = loader->interfaceId;
+        return (id / 32 < interfaceSetWords) && ((interfaceSet[id / 32] >> (id % 32)) & 0x01);
+    }
+    /* Every super class of a linked class is linked, so an unlinked loader can not be one of them */
+    if(!(loader->loaderFlags & FLAG_LINKED)) return false;
+    uint16_t depth = loader->superDepth;
+    return (depth <= superDepth) && (superDisplay[depth] == loader);
+}
+
+bool ClassLoader::initLayout(FExec *ctx) {
+    if(loaderFlags & FLAG_LAYOUT) return true;
+    flint->lock();
+    if(!(loaderFlags & FLAG_LAYOUT)) {
+        /* Don't use getSuperClass here, creating the JClass of the super class needs the layout of java/lang/Class */
+        ClassLoader *superLd = NULL;
+        const char *superName = getSuperClassName();
+        if(superName != NULL) {
+            superLd = flint->findLoader(ctx, superName);
+            if(superLd == NULL || !superLd->initLayout(ctx)) { flint->unlock(); return false; }
+        }
+        uint16_t superSlotCount = (superLd != NULL) ? superLd->instanceSlotCount : 0;
+        uint16_t slotCount = superSlotCount;
+        uint16_t objCount = (superLd != NULL) ? superLd->instanceObjCount : 0;
+        for(uint16_t i = 0; i < fieldsCount; i++) {
+            FieldInfo *fieldInfo = &fields[i];
+            if(fieldInfo->accessFlag & FIELD_STATIC) continue;
+            fieldInfo->slot = slotCount;
+            switch(fieldInfo->desc[0]) {
+                case 'J':   /* Long */
+                case 'D':   /* Double */
+                    slotCount += 2;
+                    break;
+                case 'L':   /* Object */
+                case '[':   /* Array */
+                    objCount++;
+                    slotCount++;
+                    break;
+                default:
+                    slotCount++;
+                    break;
+            }
+        }
+        uint32_t *refMap = NULL;
+        if(objCount > 0) {
+            uint32_t words = (slotCount + 31) / 32;
+            refMap = (uint32_t *)flint->malloc(ctx, words * sizeof(uint32_t));
+            if(refMap == NULL) { flint->unlock(); return false; }
+            memset(refMap, 0, words * sizeof(uint32_t));
+            if(superLd != NULL && superLd->instanceRefMap != NULL)
+                memcpy(refMap, superLd->instanceRefMap, ((superSlotCount + 31) / 32) * sizeof(uint32_t));
+            for(uint16_t i = 0; i < fieldsCount; i++) {
+                FieldInfo *fieldInfo = &fields[i];
+                if(!(fieldInfo->accessFlag & FIELD_STATIC) && (fieldInfo->desc[0] == 'L' || fieldInfo->desc[0] == '['))
+                    refMap[fieldInfo->slot / 32] |= 1U << (fieldInfo->slot % 32);
+            }
+        }
+        superLoader = superLd;
+        instanceSlotCount = slotCount;
+        instanceObjCount = objCount;
+        instanceRefMap = refMap;
+        loaderFlags |= FLAG_LAYOUT;
+    }
+    flint->unlock();
+    return true;
+}
+
+uint32_t ClassLoader::getInstanceSize(void) const {
+    return instanceSlotCount * sizeof(FieldValue);
+}
+
+uint16_t ClassLoader::hasInstanceObjField(void) const {
+    return instanceObjCount;
+}
+
+const uint32_t *ClassLoader::getInstanceRefMap(void) const {
+    return instanceRefMap;
+}
+
+FieldInfo *ClassLoader::getInstanceField(ConstNameAndType *nameAndType) const {
+    for(const ClassLoader *ld = this; ld != NULL; ld = ld->superLoader) {
+        FieldInfo *fieldInfo = ld->getFieldInfo(nameAndType, false);
+        if(fieldInfo != NULL) return fieldInfo;
+    }
+    return NULL;
+}
+
+FieldInfo *ClassLoader::getInstanceField(const char *name) const {
+    for(const ClassLoader *ld = this; ld != NULL; ld = ld->superLoader) {
+        FieldInfo *fieldInfo = ld->getFieldInfo(name, false);
+        if(fieldInfo != NULL) return fieldInfo;
+    }
+    return NULL;
+}
+
+bool ClassLoader::link(FExec *ctx) {
+    if(loaderFlags & FLAG_LINKED) return true;
+    flint->lock();
+    if(!(loaderFlags & FLAG_LINKED)) {
+        if(!initLayout(ctx)) { flint->unlock(); return false; }
+        if(superLoader != NULL && !superLoader->link(ctx)) { flint->unlock(); return false; }
+        /* An interface has no vtable, the tableIndex of its methods is their itable slot, set when the class is read */
+        bool isInterface = (accessFlags & CLASS_INTERFACE) != 0;
+        if((!isInterface && !buildVtable(ctx, superLoader)) || !buildItables(ctx, superLoader) || !buildTypeDisplay(ctx, superLoader)) {
+            freeTables();
+            flint->unlock();
+            return false;
+        }
+        loaderFlags |= FLAG_LINKED;
+    }
+    flint->unlock();
+    return true;
+}
+
+MethodInfo *ClassLoader::getVirtualMethod(FExec *ctx, MethodInfo *method) {
+    if(!link(ctx)) return NULL;
+    uint16_t index = method->tableIndex;
+    if(index == NON_VIRTUAL_INDEX) return method;
+    ClassLoader *owner = method->loader;
+    MethodInfo *ret = NULL;
+    if(owner->accessFlags & CLASS_INTERFACE) {
+        for(uint16_t i = 0; i < itablesCount; i++) {
+            if(itables[i].loader == owner) {
+                ret = itables[i].methods[index];
+                break;
+            }
+        }
+    }
+    else if(index < vtableLength)
+        ret = vtable[index];
+    if(ret == NULL) {
+        if(ctx != NULL) {
+            JClass *excpCls = flint->findClass(ctx, "java/lang/IncompatibleClassChangeError");
+            ctx->throwNew(excpCls, "Class %s does not implement %s.%s", getName(), owner->getName(), method->name);
+        }
+        return NULL;
+    }
+    if(ret->accessFlag & METHOD_ABSTRACT) {
+        if(ctx != NULL) {
+            JClass *excpCls = flint->findClass(ctx, "java/lang/AbstractMethodError");
+            ctx->throwNew(excpCls, "%s.%s", ret->loader->getName(), ret->name);
+        }
+        return NULL;
+    }
+    if(ret->accessFlag & METHOD_UNLOADED)
+        return ret->loader->getMethodInfo(ctx, (uint16_t)(ret - ret->loader->methods));
+    return ret;
+}
+
+MethodInfo *ClassLoader::getVtableMethod(uint16_t index) const {
+    if(!(loaderFlags & FLAG_LINKED) || index >= vtableLength) return NULL;
+    return vtable[index];
+}
+
 bool ClassLoader::hasStaticField(void) const {
     return (loaderFlags & FLAG_HAS_STATIC_FIELD) ? true : false;
 }
@@ -687,17 +1252,26 @@ uint16_t ClassLoader::hasStaticObjField(void) const {
 }
 
 FieldValue *ClassLoader::getStaticField(FExec *ctx, ConstField *field) const {
-    FieldValue *ret = staticFields->getField(field);
-    if(ret == NULL && ctx != NULL)
-        throwNoSuchFieldError(ctx, field->className, field->nameAndType->name);
-    return ret;
+    if(field->fieldIndex == 0) {
+        FieldInfo *fieldInfo = getFieldInfo(field->nameAndType, true);
+        if(fieldInfo == NULL) {
+            if(ctx != NULL)
+                throwNoSuchFieldError(ctx, field->className, field->nameAndType->name);
+            return NULL;
+        }
+        field->fieldIndex = fieldInfo->slot | 0x80000000;
+    }
+    return staticFields->getFieldByIndex(field->fieldIndex & 0x7FFFFFFF);
 }
 
 FieldValue *ClassLoader::getStaticField(FExec *ctx, const char *name) const {
-    FieldValue *ret = staticFields->getField(name);
-    if(ret == NULL && ctx != NULL)
-        throwNoSuchFieldError(ctx, getName(), name);
-    return ret;
+    FieldInfo *fieldInfo = getFieldInfo(name, true);
+    if(fieldInfo == NULL) {
+        if(ctx != NULL)
+            throwNoSuchFieldError(ctx, getName(), name);
+        return NULL;
+    }
+    return staticFields->getFieldByIndex(fieldInfo->slot);
 }
 
 FieldValue *ClassLoader::getStaticFieldByIndex(uint32_t index) const {
@@ -718,7 +1292,32 @@ bool ClassLoader::initStaticFields(FExec *ctx) {
     staticFields = (FieldsData *)flint->malloc(ctx, sizeof(FieldsData));
     if(staticFields == NULL) return false;
     new (staticFields)FieldsData();
-    return staticFields->init(flint, ctx, this, true);
+    return staticFields->init(flint, ctx, this);
+}
+
+void ClassLoader::freeTables(void) {
+    if(vtable != NULL) {
+        flint->free(vtable);
+        vtable = NULL;
+    }
+    vtableLength = 0;
+    if(itables != NULL) {
+        for(uint16_t i = 0; i < itablesCount; i++)
+            if(itables[i].methods) flint->free(itables[i].methods);
+        flint->free(itables);
+        itables = NULL;
+    }
+    itablesCount = 0;
+    if(superDisplay != NULL) {
+        flint->free(superDisplay);
+        superDisplay = NULL;
+    }
+    superDepth = 0;
+    if(interfaceSet != NULL) {
+        flint->free(interfaceSet);
+        interfaceSet = NULL;
+    }
+    interfaceSetWords = 0;
 }
 
 void ClassLoader::clearStaticFields(void) {
@@ -730,6 +1329,15 @@ void ClassLoader::clearStaticFields(void) {
     }
 }
 
+void ClassLoader::clearConstFieldValues(void) {
+    for(uint32_t i = 0; i < poolCount; i++) {
+        if(poolTable[i].tag == CONST_FIELD)
+            ((ConstField *)poolTable[i].value)->staticValue = NULL;
+        else if(poolTable[i].tag == CONST_LONG || poolTable[i].tag == CONST_DOUBLE)
+            i++;
+    }
+}
+
 ClassLoader::~ClassLoader(void) {
     if(poolCount && poolTable) {
         for(uint32_t i = 0; i < poolCount; i++) {
@@ -758,16 +1366,19 @@ ClassLoader::~ClassLoader(void) {
     }
     if(interfacesCount && interfaces)
         flint->free(interfaces);
+    if(instanceRefMap)
+        flint->free(instanceRefMap);
     if(fieldsCount && fields)
         flint->free(fields);
     if(methodsCount && methods) {
         for(uint32_t i = 0; i < methodsCount; i++) {
             if(!(methods[i].accessFlag & (METHOD_NATIVE | METHOD_UNLOADED)) && methods[i].code)
-                flint->free(methods[i].code);
+                freeAttributeCode((CodeAttribute *)methods[i].code);
         }
         flint->free(methods);
     }
     if(nestMembersCount && nestMembers)
         flint->free(nestMembers);
+    freeTables();
     clearStaticFields();
 }
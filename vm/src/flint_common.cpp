@@ -1,6 +1,7 @@
 
 #include "flint.h"
 #include "flint_common.h"
+#include "flint_opcodes.h"
 
 static const uint16_t crc16Table[] = {
     0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
@@ -99,3 +100,60 @@ uint8_t GetArgSlotCount(const char *desc) {
     }
     return argc;
 }
+
+uint32_t GetInstructionLength(const uint8_t *code, uint32_t pc) {
+    switch(code[pc]) {
+        case OP_BIPUSH:
+        case OP_LDC:
+        case OP_ILOAD ... OP_ALOAD:
+        case OP_ISTORE ... OP_ASTORE:
+        case OP_RET:
+        case OP_NEWARRAY:
+        case OP_LDC_QUICK:
+        case OP_ILOAD_ILOAD_IADD:
+        case OP_ILOAD_ICONST_IF_ICMP:
+        case OP_ALOAD_ARRAYLENGTH:
+            return 2;
+        case OP_SIPUSH:
+        case OP_LDC_W:
+        case OP_LDC2_W:
+        case OP_IINC:
+        case OP_IFEQ ... OP_JSR:
+        case OP_GETSTATIC ... OP_INVOKESTATIC:
+        case OP_NEW:
+        case OP_ANEWARRAY:
+        case OP_CHECKCAST:
+        case OP_INSTANCEOF:
+        case OP_IFNULL_PTR:
+        case OP_IFNONNULL_PTR:
+        case OP_INVOKEVIRTUAL_IC:
+        case OP_LDC_W_QUICK ... OP_INVOKEVIRTUAL_QUICK:
+        case OP_IINC_GOTO:
+        case OP_INVOKESTATIC_QUICK:
+        case OP_INVOKESPECIAL_QUICK:
+            return 3;
+        case OP_MULTIANEWARRAY:
+            return 4;
+        case OP_INVOKEINTERFACE:
+        case OP_INVOKEINTERFACE_IC:
+        case OP_INVOKEDYNAMIC:
+        case OP_GOTO_W:
+        case OP_JSRW:
+            return 5;
+        case OP_WIDE:
+            return (code[pc + 1] == OP_IINC) ? 6 : 4;
+        case OP_TABLESWITCH: {
+            const uint8_t *p = &code[(pc + 4) & ~0x03];
+            int32_t low = (int32_t)((p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7]);
+            int32_t high = (int32_t)((p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11]);
+            return (uint32_t)(&p[12] - &code[pc]) + (high - low + 1) * 4;
+        }
+        case OP_LOOKUPSWITCH: {
+            const uint8_t *p = &code[(pc + 4) & ~0x03];
+            int32_t npairs = (int32_t)((p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7]);
+            return (uint32_t)(&p[8] - &code[pc]) + npairs * 8;
+        }
+        default:
+            return 1;
+    }
+}
@@ -19,7 +19,7 @@ bool ConstNameAndType::operator!=(ConstNameAndType &another) const {
 }
 
 ConstField::ConstField(const char *className, ConstNameAndType *nameAndType) :
-className(className), loader(NULL), nameAndType(nameAndType), fieldIndex(0) {
+className(className), loader(NULL), nameAndType(nameAndType), fieldIndex(0), staticValue(NULL) {
 
 }
 
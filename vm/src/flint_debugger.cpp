@@ -499,10 +499,11 @@ void FDbg::readFieldRequest(JObject *obj, const char *fieldName) {
     if(csr & DBG_STATUS_STOP) {
         if(!flint->isObject(obj))
             return (void)sendRespCode(DBG_CMD_READ_FIELD, DBG_RESP_FAIL);
-        FieldValue *field = obj->getField(NULL, fieldName);
-        if(field == NULL)
+        FieldInfo *fieldInfo = flint->getFieldsLoader(obj)->getInstanceField(fieldName);
+        if(fieldInfo == NULL)
             return (void)sendRespCode(DBG_CMD_READ_FIELD, DBG_RESP_FAIL);
-        char c = field->getFieldInfo()->desc[0];
+        FieldValue *field = obj->getFieldByIndex(fieldInfo->getSlot());
+        char c = fieldInfo->desc[0];
         if(c == 'J' || c == 'D') {
             initDataFrame(DBG_CMD_READ_FIELD, DBG_RESP_OK, 12);
             if(!dataFrameAppend((uint32_t)8)) return;
@@ -590,6 +591,9 @@ void FDbg::readObjSizeAndTypeRequest(JObject *obj) {
 void FDbg::openFileRequest(char *fileName, FlintAPI::IO::FileMode mode) {
     if(fileHandle)
         FlintAPI::IO::fclose(fileHandle);
+    /* Jars kept open by the VM would block or go stale when a new one is uploaded */
+    if(flint != NULL && (mode & FlintAPI::IO::FILE_MODE_WRITE))
+        flint->freeAllFileHandle();
     for(uint16_t i = 0; fileName[i]; i++) {
         if((fileName[i] == '/') || (fileName[i] == '\\')) {
             fileName[i] = 0;
@@ -739,6 +743,44 @@ void FDbg::readConsoleBufferRequest(void) {
     consoleMutex.unlock();
 }
 
+void FDbg::dumpHeapRequest(const char *path) {
+    dbgMutex.lock();
+    bool ret = (flint != NULL) && flint->dumpHeap(path);
+    dbgMutex.unlock();
+    sendRespCode(DBG_CMD_DUMP_HEAP, ret ? DBG_RESP_OK : DBG_RESP_FAIL);
+}
+
+void FDbg::readGcStatsRequest(void) {
+    GcStats stats;
+    dbgMutex.lock();
+    if(flint == NULL) {
+        dbgMutex.unlock();
+        sendRespCode(DBG_CMD_READ_GC_STATS, DBG_RESP_FAIL);
+        return;
+    }
+    flint->getGcStats(&stats);
+    dbgMutex.unlock();
+
+    initDataFrame(DBG_CMD_READ_GC_STATS, DBG_RESP_OK, 12 * sizeof(uint32_t) + 4 * sizeof(uint64_t));
+    if(!dataFrameAppend(stats.minorCount)) return;
+    if(!dataFrameAppend(stats.fullCount)) return;
+    if(!dataFrameAppend(stats.pauseCount)) return;
+    if(!dataFrameAppend(stats.lastPauseUs)) return;
+    if(!dataFrameAppend(stats.maxPauseUs)) return;
+    if(!dataFrameAppend(stats.totalPauseUs)) return;
+    if(!dataFrameAppend(stats.lastFreedBytes)) return;
+    if(!dataFrameAppend(stats.lastFreedObjects)) return;
+    if(!dataFrameAppend(stats.totalFreedBytes)) return;
+    if(!dataFrameAppend(stats.totalFreedObjects)) return;
+    if(!dataFrameAppend(stats.totalAllocatedBytes)) return;
+    if(!dataFrameAppend(stats.allocationRate)) return;
+    if(!dataFrameAppend(stats.liveBytes)) return;
+    if(!dataFrameAppend(stats.usedBytes)) return;
+    if(!dataFrameAppend(stats.gcThreshold)) return;
+    if(!dataFrameAppend(stats.heapBlocks)) return;
+    dataFrameFinish();
+}
+
 bool FDbg::receivedDataHandler(uint8_t *data, uint32_t length) {
     DbgCmd cmd = (DbgCmd)(data[1] & 0x3F);
     uint32_t rxLen = (data[1] >> 6) | (data[2] << 2) | (data[3] << 10);
@@ -1007,6 +1049,22 @@ bool FDbg::receivedDataHandler(uint8_t *data, uint32_t length) {
                 readConsoleBufferRequest();
             return true;
         }
+        case DBG_CMD_READ_GC_STATS: {
+            if(length != 6)
+                sendRespCode(cmd, DBG_RESP_INVALID_FORMAT);
+            else
+                readGcStatsRequest();
+            return true;
+        }
+        case DBG_CMD_DUMP_HEAP: {
+            if(length >= 12) {
+                const char *path = (char *)&data[4 + 2];
+                dumpHeapRequest(path);
+            }
+            else
+                sendRespCode(cmd, DBG_RESP_INVALID_FORMAT);
+            return true;
+        }
         default: {
             sendRespCode(cmd, DBG_RESP_UNKNOW);
             return true;
@@ -11,14 +11,44 @@
 #define DOUBLE_NAN                          0x7FF8000000000000
 
 #define ARRAY_TO_INT16(array)               (int16_t)(((array)[0] << 8) | (array)[1])
-#define ARRAY_TO_INT32(array)               (int32_t)(((array)[0] << 24) | ((array)[1] << 16) | ((array)[2] << 8) | (array)[3])
 
+/* Operands the class loader rewrote to native byte order, memcpy compiles to one load where unaligned access is allowed */
+#define CODE_INT16(array)                   readCodeInt16(array)
+#define CODE_INT32(array)                   readCodeInt32(array)
+
+/*
+ * The operand stack stays in memory between instructions, the GC scans it while the thread runs and the debugger
+ * reads it from another thread. The int and float operations work on the top slots in place instead, so they
+ * write sp once rather than once per pop and push
+ */
 #define GET_STACK_VALUE(_index)             stack[_index]
 #define SET_STACK_VALUE(_index, _value)     stack[_index] = _value
 
+static inline int16_t readCodeInt16(const uint8_t *p) {
+    int16_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline int32_t readCodeInt32(const uint8_t *p) {
+    int32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+#define FIELD_SLOT(constField)              ((constField)->fieldIndex & 0x7FFFFFFF)
+
 static const void **opcodeLabelsStop = NULL;
 static const void **opcodeLabelsExit = NULL;
 
+static inline void Quicken(const uint8_t *code, uint32_t pc, FlintOpCode opcode, FlintOpCode quickOpcode) {
+    /*
+     * Only the opcode byte is patched, the operands are the same for both forms so a thread racing on this site is still fine.
+     * If the debugger has put a breakpoint here, the site is left as it is
+     */
+    if(code[pc] == opcode) ((uint8_t *)code)[pc] = quickOpcode;
+}
+
 jclass FExec::findClass(const char *name, uint16_t length) {
     if((length == 15 || length == 0xFFFF) && strncmp("java/lang/Class", name, 15) == 0)
         return flint->getClassOfClass(this);
@@ -118,155 +148,162 @@ jobjectArray FExec::newObjectArray(jclass type, uint32_t count) {
 
 static void InvalidAccessFieldType(FExec *exec, jfieldId fid) {
     jclass excp = exec->findClass("java/lang/IllegalAccessException");
-    const char *desc = fid->getFieldInfo()->desc;
-    const char *name = fid->getFieldInfo()->name;
-    exec->throwNew(excp, "Incorrect type access to %s %s", desc, name);
+    exec->throwNew(excp, "Incorrect type access to %s %s", fid->desc, fid->name);
 }
 
 jfieldId FExec::getFieldId(jobject obj, const char *name) {
-    return obj->getField(this, name);
+    jfieldId fid = flint->getFieldsLoader(obj)->getInstanceField(name);
+    if(fid == NULL) {
+        jclass excpCls = findClass("java/lang/NoSuchFieldError");
+        throwNew(excpCls, "Could not find the field %s.%s", obj->getTypeName(), name);
+    }
+    return fid;
 }
 
-jbool FExec::getBoolField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'Z') {
+jbool FExec::getBoolField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'Z') {
         InvalidAccessFieldType(this, fid);
         return false;
     }
-    return fid->getInt32();
+    return obj->getFieldByIndex(fid->getSlot())->getInt32();
 }
 
-jbyte FExec::getByteField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'B') {
+jbyte FExec::getByteField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'B') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    return fid->getInt32();
+    return obj->getFieldByIndex(fid->getSlot())->getInt32();
 }
 
-jchar FExec::getCharField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'C') {
+jchar FExec::getCharField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'C') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    return fid->getInt32();
+    return obj->getFieldByIndex(fid->getSlot())->getInt32();
 }
 
-jshort FExec::getShortField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'S') {
+jshort FExec::getShortField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'S') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    return fid->getInt32();
+    return obj->getFieldByIndex(fid->getSlot())->getInt32();
 }
 
-jint FExec::getIntField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'I') {
+jint FExec::getIntField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'I') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    return fid->getInt32();
+    return obj->getFieldByIndex(fid->getSlot())->getInt32();
 }
 
-jfloat FExec::getFloatField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'F') {
+jfloat FExec::getFloatField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'F') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    int32_t ret = fid->getInt32();
+    int32_t ret = obj->getFieldByIndex(fid->getSlot())->getInt32();
     return *(float *)&ret;
 }
 
-jlong FExec::getLongField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] != 'J') {
+jlong FExec::getLongField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'J') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    return fid->getInt64();
+    return obj->getFieldByIndex(fid->getSlot())->getInt64();
 }
 
-jdouble FExec::getDoubleField(jfieldId fid) {
-    if(fid->getFieldInfo()->desc[0] == 'D') {
+jdouble FExec::getDoubleField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] != 'D') {
         InvalidAccessFieldType(this, fid);
         return 0;
     }
-    int64_t ret = fid->getInt64();
+    int64_t ret = obj->getFieldByIndex(fid->getSlot())->getInt64();
     return *(double *)&ret;
 }
 
-jobject FExec::getObjField(jfieldId fid) {
-    const char *desc = fid->getFieldInfo()->desc;
-    if(desc[0] == 'L' || desc[0] == '[')
-        return fid->getObj();
+jobject FExec::getObjField(jobject obj, jfieldId fid) {
+    if(fid->desc[0] == 'L' || fid->desc[0] == '[')
+        return obj->getFieldByIndex(fid->getSlot())->getObj();
     InvalidAccessFieldType(this, fid);
     return NULL;
 }
 
-jvoid FExec::setBoolField(jfieldId fid, jbool val) {
-    if(fid->getFieldInfo()->desc[0] != 'Z')
+jvoid FExec::setBoolField(jobject obj, jfieldId fid, jbool val) {
+    if(fid->desc[0] != 'Z')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt32(val);
+        obj->getFieldByIndex(fid->getSlot())->setInt32(val);
 }
 
-jvoid FExec::setByteField(jfieldId fid, jbyte val) {
-    if(fid->getFieldInfo()->desc[0] != 'B')
+jvoid FExec::setByteField(jobject obj, jfieldId fid, jbyte val) {
+    if(fid->desc[0] != 'B')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt32(val);
+        obj->getFieldByIndex(fid->getSlot())->setInt32(val);
 }
 
-jvoid FExec::setCharField(jfieldId fid, jchar val) {
-    if(fid->getFieldInfo()->desc[0] != 'C')
+jvoid FExec::setCharField(jobject obj, jfieldId fid, jchar val) {
+    if(fid->desc[0] != 'C')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt32(val);
+        obj->getFieldByIndex(fid->getSlot())->setInt32(val);
 }
 
-jvoid FExec::setShortField(jfieldId fid, jshort val) {
-    if(fid->getFieldInfo()->desc[0] != 'S')
+jvoid FExec::setShortField(jobject obj, jfieldId fid, jshort val) {
+    if(fid->desc[0] != 'S')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt32(val);
+        obj->getFieldByIndex(fid->getSlot())->setInt32(val);
 }
 
-jvoid FExec::setIntField(jfieldId fid, jint val) {
-    if(fid->getFieldInfo()->desc[0] != 'I')
+jvoid FExec::setIntField(jobject obj, jfieldId fid, jint val) {
+    if(fid->desc[0] != 'I')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt32(val);
+        obj->getFieldByIndex(fid->getSlot())->setInt32(val);
 }
 
-jvoid FExec::setFloatField(jfieldId fid, jfloat val) {
-    if(fid->getFieldInfo()->desc[0] != 'F')
+jvoid FExec::setFloatField(jobject obj, jfieldId fid, jfloat val) {
+    if(fid->desc[0] != 'F')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt32(*(int32_t *)&val);
+        obj->getFieldByIndex(fid->getSlot())->setInt32(*(int32_t *)&val);
 }
 
-jvoid FExec::setLongField(jfieldId fid, jlong val) {
-    if(fid->getFieldInfo()->desc[0] != 'J')
+jvoid FExec::setLongField(jobject obj, jfieldId fid, jlong val) {
+    if(fid->desc[0] != 'J')
         InvalidAccessFieldType(this, fid);
     else
-        fid->setInt64(val);
+        obj->getFieldByIndex(fid->getSlot())->setInt64(val);
 }
 
-jvoid FExec::setDoubleField(jfieldId fid, jdouble val) {
-    if(fid->getFieldInfo()->desc[0] != 'D')
+jvoid FExec::setDoubleField(jobject obj, jfieldId fid, jdouble val) {
+    if(fid->desc[0] != 'D')
         InvalidAccessFieldType(this, fid);
     else {
         double v = val;
-        fid->setInt64(*(int64_t *)&v);
+        obj->getFieldByIndex(fid->getSlot())->setInt64(*(int64_t *)&v);
     }
 }
 
-jvoid FExec::setObjField(jfieldId fid, jobject obj) {
-    const char *desc = fid->getFieldInfo()->desc;
-    if(desc[0] == 'L' || desc[0] == '[')
-        fid->setObj(obj);
+jvoid FExec::setObjField(jobject obj, jfieldId fid, jobject val) {
+    if(fid->desc[0] == 'L' || fid->desc[0] == '[') {
+        obj->getFieldByIndex(fid->getSlot())->setObj(val);
+        flint->writeBarrier(this, obj, val);
+    }
     else
         InvalidAccessFieldType(this, fid);
 }
 
+jvoid FExec::writeBarrier(jobject obj, jobject val) {
+    flint->writeBarrier(this, obj, val);
+}
+
 jmethodId FExec::getMethodId(jclass cls, const char *name, const char *sig) {
     ConstNameAndType nameAndType(name, sig);
     return flint->findMethod(this, cls, &nameAndType);
@@ -353,7 +390,7 @@ jvoid FExec::freeObject(jobject obj) {
     flint->freeObject(obj);
 }
 
-FExec::FExec(Flint *flint, JThread *owner, uint32_t stackSize) : ListNode(), FNIEnv(), flint(flint), stackLength(stackSize / sizeof(int32_t)) {
+FExec::FExec(Flint *flint, JThread *owner, uint32_t stackSize) : ListNode(), FNIEnv(), flint(flint), stackLength(stackSize / sizeof(int32_t)), allocLock(), newObjs() {
     this->opcodes = 0;
     this->lr = -1;
     this->sp = -1;
@@ -362,6 +399,10 @@ FExec::FExec(Flint *flint, JThread *owner, uint32_t stackSize) : ListNode(), FNI
     this->ownerThread = owner;
     this->excp = NULL;
     this->currentWaiting = NULL;
+    this->monitorNext = NULL;
+    for(uint32_t i = 0; i < HEAP_SIZE_CLASS_COUNT; i++)
+        this->tlab[i] = NULL;
+    this->lastRemembered = NULL;
 }
 
 Flint *FExec::getFlint(void) const {
@@ -518,51 +559,19 @@ void FExec::initExitPoint(MethodInfo *methodInfo) {
 }
 
 bool FExec::lockClass(ClassLoader *cls) {
-    flint->lock();
-    if(cls->monitorCount == 0 || cls->monitorOwnId == (int32_t)this) {
-        cls->monitorOwnId = (int32_t)this;
-        if(cls->monitorCount < 0xFFFFFFFF) {
-            cls->monitorCount++;
-            flint->unlock();
-            return true;
-        }
-        flint->unlock();
-        FExec::throwNew(flint->findClass(this, "java/lang/IllegalMonitorStateException"));
-        return false;
-    }
-    flint->unlock();
-    return false;
+    return flint->monitorEnter(this, &cls->monitor);
 }
 
 void FExec::unlockClass(ClassLoader *cls) {
-    flint->lock();
-    if(cls->monitorCount)
-        cls->monitorCount--;
-    flint->unlock();
+    flint->monitorExit(this, &cls->monitor);
 }
 
 bool FExec::lockObject(JObject *obj) {
-    flint->lock();
-    if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
-        obj->ownId = (int32_t)this;
-        if(obj->monitorCount < 0xFFFFFFFF) {
-            obj->monitorCount++;
-            flint->unlock();
-            return true;
-        }
-        flint->unlock();
-        FExec::throwNew(flint->findClass(this, "java/lang/IllegalMonitorStateException"));
-        return false;
-    }
-    flint->unlock();
-    return false;
+    return flint->monitorEnter(this, &obj->monitor);
 }
 
 void FExec::unlockObject(JObject *obj) {
-    flint->lock();
-    if(obj->monitorCount)
-        obj->monitorCount--;
-    flint->unlock();
+    flint->monitorExit(this, &obj->monitor);
 }
 
 bool FExec::checkInvokeArgs(JObject *obj, MethodInfo *methodInfo) {
@@ -599,14 +608,10 @@ uint64_t FExec::callMethod(MethodInfo *methodInfo, uint8_t argc) {
 
     /* Lock Class/Object if method is SYNCHRONIZED */
     if(flag & (METHOD_SYNCHRONIZED | METHOD_CLINIT)) {
-        if(flag & METHOD_NATIVE) while(lockClass(methodInfo->loader) == false) {
-            if(FExec::hasTerminateRequest()) return 0;
-            FlintAPI::Thread::yield();
-        }
-        else while(lockObject((JObject *)stack[sp - argc - 1]) == false) {
-            if(FExec::hasTerminateRequest()) return 0;
-            FlintAPI::Thread::yield();
+        if(flag & METHOD_NATIVE) {
+            if(lockClass(methodInfo->loader) == false) return 0;
         }
+        else if(lockObject((JObject *)stack[sp - argc - 1]) == false) return 0;
     }
 
     invoke(methodInfo, argc);
@@ -737,8 +742,10 @@ void FExec::invokeStatic(ConstMethod *constMethod) {
     }
     if(methodInfo->accessFlag & (METHOD_SYNCHRONIZED | METHOD_CLINIT)) {
         if(lockClass(methodInfo->loader) == false)
-            return FlintAPI::Thread::yield();
+            return;
     }
+    else if(methodInfo->loader->getStaticInitStatus() == INITIALIZED)
+        Quicken(code, pc, OP_INVOKESTATIC, OP_INVOKESTATIC_QUICK);
     lr = pc + 3;
     invoke(methodInfo, constMethod->getArgc());
 }
@@ -759,72 +766,102 @@ void FExec::invokeSpecial(ConstMethod *constMethod) {
     }
     if(methodInfo->accessFlag & (METHOD_SYNCHRONIZED | METHOD_CLINIT)) {
         if(lockObject((JObject *)stack[sp - argc - 1]) == false)
-            return FlintAPI::Thread::yield();
+            return;
     }
+    else if(methodInfo->loader->getStaticInitStatus() == INITIALIZED)
+        Quicken(code, pc, OP_INVOKESPECIAL, OP_INVOKESPECIAL_QUICK);
     lr = pc + 3;
     invoke(methodInfo, argc);
 }
 
-void FExec::invokeVirtual(ConstMethod *constMethod) {
-    uint8_t argc = constMethod->getArgc();
-    JObject *obj = (JObject *)stack[sp - argc];
-    if(obj == NULL) {
-        JClass *excpCls = flint->findClass(this, "java/lang/NullPointerException");
-        return FExec::throwNew(excpCls, "Cannot invoke \"%s.%s\" by null object", constMethod->className, constMethod->nameAndType->name);
-    }
-    MethodInfo *methodInfo = constMethod->methodInfo;
+MethodInfo *FExec::findVirtualMethod(ConstMethod *constMethod, JObject *obj, InlineCache *cache) {
     JClass *objType;
     if(obj->type != NULL) objType = obj->type;
     else {
         objType = flint->getClassOfClass(this);
-        if(objType == NULL) return;
+        if(objType == NULL) return NULL;
     }
-    if(methodInfo == NULL || methodInfo->loader != objType->getClassLoader()) {
-        methodInfo = flint->findMethod(this, objType, constMethod->nameAndType);
-        if(methodInfo == NULL) return;
+    if(cache != NULL) {
+        for(uint8_t i = 0; i < INLINE_CACHE_SIZE; i++) {
+            if(cache->entries[i].type == objType)
+                return cache->entries[i].target;
+        }
+    }
+    MethodInfo *methodInfo = constMethod->methodInfo;
+    if(methodInfo == NULL) {
+        methodInfo = flint->findMethod(this, flint->findClass(this, constMethod->className), constMethod->nameAndType);
+        if(methodInfo == NULL) return NULL;
         constMethod->methodInfo = methodInfo;
-        if(methodInfo->loader->getStaticInitStatus() == UNINITIALIZED)
-            return invokeStaticCtor(methodInfo->loader);
+    }
+    methodInfo = objType->getClassLoader()->getVirtualMethod(this, methodInfo);
+    if(methodInfo == NULL) return NULL;
+    if(methodInfo->loader->getStaticInitStatus() == UNINITIALIZED) {
+        invokeStaticCtor(methodInfo->loader);
+        return NULL;
+    }
+    /* Entries are only ever added (target before type), so the lookup above can run without the lock */
+    if(cache != NULL && !cache->megamorphic) {
+        flint->lock();
+        uint8_t i = 0;
+        for(; i < INLINE_CACHE_SIZE; i++) {
+            if(cache->entries[i].type == objType) break;
+            if(cache->entries[i].type == NULL) {
+                cache->entries[i].target = methodInfo;
+                cache->entries[i].type = objType;
+                break;
+            }
+        }
+        if(i == INLINE_CACHE_SIZE) cache->megamorphic = true;
+        flint->unlock();
+    }
+    return methodInfo;
+}
+
+void FExec::invokeVirtual(ConstMethod *constMethod, InlineCache *cache) {
+    uint8_t argc = constMethod->getArgc();
+    JObject *obj = (JObject *)stack[sp - argc];
+    if(obj == NULL) {
+        JClass *excpCls = flint->findClass(this, "java/lang/NullPointerException");
+        return FExec::throwNew(excpCls, "Cannot invoke \"%s.%s\" by null object", constMethod->className, constMethod->nameAndType->name);
+    }
+    MethodInfo *methodInfo = findVirtualMethod(constMethod, obj, cache);
+    if(methodInfo == NULL) return;
+    if(cache != NULL && code[pc] == OP_INVOKEVIRTUAL_IC) {
+        /* Methods declared by a class have the same vtable slot in every subclass, so the site can index the vtable directly */
+        MethodInfo *resolved = constMethod->methodInfo;
+        if(resolved->tableIndex != NON_VIRTUAL_INDEX && !(resolved->loader->getAccessFlag() & CLASS_INTERFACE)) {
+            cache->argc = argc;
+            cache->tableIndex = resolved->tableIndex;
+            Quicken(code, pc, OP_INVOKEVIRTUAL_IC, OP_INVOKEVIRTUAL_QUICK);
+        }
     }
     if(methodInfo->accessFlag & (METHOD_SYNCHRONIZED | METHOD_CLINIT)) {
         if(lockObject(obj) == false)
-            return FlintAPI::Thread::yield();
+            return;
     }
     argc++;
     lr = pc + 3;
     invoke(methodInfo, argc);
 }
 
-void FExec::invokeInterface(ConstInterfaceMethod *interfaceMethod, uint8_t argc) {
+void FExec::invokeInterface(ConstInterfaceMethod *interfaceMethod, uint8_t argc, InlineCache *cache) {
     JObject *obj = (JObject *)stack[sp - argc + 1];
     if(obj == NULL) {
         JClass *excpCls = flint->findClass(this, "java/lang/NullPointerException");
         return FExec::throwNew(excpCls, "Cannot invoke \"%s.%s\" by null object", interfaceMethod->className, interfaceMethod->nameAndType->name);
     }
-    MethodInfo *methodInfo = interfaceMethod->methodInfo;
-    JClass *objType;
-    if(obj->type != NULL) objType = obj->type;
-    else {
-        objType = flint->getClassOfClass(this);
-        if(objType == NULL) return;
-    }
-    if(methodInfo == NULL || methodInfo->loader != objType->getClassLoader()) {
-        methodInfo = flint->findMethod(this, objType, interfaceMethod->nameAndType);
-        if(methodInfo == NULL) return;
-        interfaceMethod->methodInfo = methodInfo;
-        if(methodInfo->loader->getStaticInitStatus() == UNINITIALIZED)
-            return invokeStaticCtor(methodInfo->loader);
-    }
+    MethodInfo *methodInfo = findVirtualMethod(interfaceMethod, obj, cache);
+    if(methodInfo == NULL) return;
     if(methodInfo->accessFlag & (METHOD_SYNCHRONIZED | METHOD_CLINIT)) {
         if(lockObject(obj) == false)
-            return FlintAPI::Thread::yield();
+            return;
     }
     lr = pc + 5;
     invoke(methodInfo, argc);
 }
 
 void FExec::invokeStaticCtor(ClassLoader *loader) {
-    if(lockClass(loader) == false) { FlintAPI::Thread::yield(); return; }
+    if(lockClass(loader) == false) return;
     if(loader->getStaticInitStatus() != UNINITIALIZED) { unlockClass(loader); return; }
     if(loader->initStaticFields(this) == false) { unlockClass(loader); return; }
     if(loader->hasStaticCtor()) {
@@ -854,6 +891,8 @@ void FExec::exec(bool initOpcodeLabels) {
     if(initOpcodeLabels) opcodes = (const void ** volatile)opcodeLabels;
 
     const uint8_t *code = this->code;
+    uint32_t fusedLocal;    /* Local variable read by the first instruction of a superinstruction */
+    uint32_t fusedNext;     /* Pc of the instruction after that first one */
 
     if(method->loader->getStaticInitStatus() == UNINITIALIZED) {
         invokeStaticCtor(method->loader);
@@ -938,7 +977,7 @@ void FExec::exec(bool initOpcodeLabels) {
         pc += 2;
         goto *opcodes[code[pc]];
     op_sipush:
-        stackPushInt32(ARRAY_TO_INT16(&code[pc + 1]));
+        stackPushInt32(CODE_INT16(&code[pc + 1]));
         pc += 3;
         goto *opcodes[code[pc]];
     op_ldc: {
@@ -956,6 +995,7 @@ void FExec::exec(bool initOpcodeLabels) {
             case CONST_STRING: {
                 JString *str = loader->getConstString(this, poolIndex);
                 if(str == NULL) goto exception_handler;
+                Quicken(code, pc, OP_LDC, OP_LDC_QUICK);
                 stackPushObject(str);
                 pc += 2;
                 goto *opcodes[code[pc]];
@@ -963,6 +1003,7 @@ void FExec::exec(bool initOpcodeLabels) {
             case CONST_CLASS: {
                 JClass *cls = loader->getConstClass(this, poolIndex);
                 if(cls == NULL) goto exception_handler;
+                Quicken(code, pc, OP_LDC, OP_LDC_QUICK);
                 stackPushObject(cls);
                 pc += 2;
                 goto *opcodes[code[pc]];
@@ -997,6 +1038,7 @@ void FExec::exec(bool initOpcodeLabels) {
             case CONST_STRING: {
                 JString *str = loader->getConstString(this, poolIndex);
                 if(str == NULL) goto exception_handler;
+                Quicken(code, pc, OP_LDC_W, OP_LDC_W_QUICK);
                 stackPushObject(str);
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -1004,6 +1046,7 @@ void FExec::exec(bool initOpcodeLabels) {
             case CONST_CLASS: {
                 JClass *cls = loader->getConstClass(this, poolIndex);
                 if(cls == NULL) goto exception_handler;
+                Quicken(code, pc, OP_LDC_W, OP_LDC_W_QUICK);
                 stackPushObject(cls);
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -1274,8 +1317,7 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_iastore:
-    op_fastore:
-    op_aastore: {
+    op_fastore: {
         int32_t value = stackPopInt32();
         int32_t index = stackPopInt32();
         JObject *obj = stackPopObject();
@@ -1290,6 +1332,22 @@ void FExec::exec(bool initOpcodeLabels) {
         pc++;
         goto *opcodes[code[pc]];
     }
+    op_aastore: {
+        JObject *value = stackPopObject();
+        int32_t index = stackPopInt32();
+        JObject *obj = stackPopObject();
+        if(obj == NULL)
+            goto store_null_array_excp;
+        else if((index < 0) || (index >= (obj->size / sizeof(int32_t)))) {
+            JClass *excpCls = flint->findClass(this, "java/lang/ArrayIndexOutOfBoundsException");
+            FExec::throwNew(excpCls, "Index %d out of bounds for length %d", index, (obj->size / sizeof(int32_t)));
+            goto exception_handler;
+        }
+        ((JObject **)obj->data)[index] = value;
+        flint->writeBarrier(this, obj, value);
+        pc++;
+        goto *opcodes[code[pc]];
+    }
     op_lastore:
     op_dastore: {
         int64_t value = stackPopInt64();
@@ -1419,9 +1477,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_iadd: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 + value2);
+        int32_t *values = &stack[--sp];
+        values[0] = values[0] + values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1433,9 +1490,10 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_fadd: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 + value2);
+        float values[2];
+        memcpy(values, &stack[--sp], sizeof(values));
+        values[0] = values[0] + values[1];
+        memcpy(&stack[sp], values, sizeof(float));
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1447,9 +1505,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_isub: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 - value2);
+        int32_t *values = &stack[--sp];
+        values[0] = values[0] - values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1461,9 +1518,10 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_fsub: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 - value2);
+        float values[2];
+        memcpy(values, &stack[--sp], sizeof(values));
+        values[0] = values[0] - values[1];
+        memcpy(&stack[sp], values, sizeof(float));
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1475,9 +1533,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_imul: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 * value2);
+        int32_t *values = &stack[--sp];
+        values[0] = values[0] * values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1489,9 +1546,10 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_fmul: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 * value2);
+        float values[2];
+        memcpy(values, &stack[--sp], sizeof(values));
+        values[0] = values[0] * values[1];
+        memcpy(&stack[sp], values, sizeof(float));
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1503,11 +1561,10 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_idiv: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        if(value2 == 0)
+        int32_t *values = &stack[--sp];
+        if(values[1] == 0)
             goto divided_by_zero_excp;
-        stackPushInt32(value1 / value2);
+        values[0] = values[0] / values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1521,9 +1578,10 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_fdiv: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 / value2);
+        float values[2];
+        memcpy(values, &stack[--sp], sizeof(values));
+        values[0] = values[0] / values[1];
+        memcpy(&stack[sp], values, sizeof(float));
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1535,11 +1593,10 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_irem: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        if(value2 == 0)
+        int32_t *values = &stack[--sp];
+        if(values[1] == 0)
             goto divided_by_zero_excp;
-        stackPushInt32(value1 % value2);
+        values[0] = values[0] % values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1576,18 +1633,21 @@ void FExec::exec(bool initOpcodeLabels) {
         stackPushInt64(-stackPopInt64());
         pc++;
         goto *opcodes[code[pc]];
-    op_fneg:
-        stackPushFloat(-stackPopFloat());
+    op_fneg: {
+        float value;
+        memcpy(&value, &stack[sp], sizeof(value));
+        value = -value;
+        memcpy(&stack[sp], &value, sizeof(value));
         pc++;
         goto *opcodes[code[pc]];
+    }
     op_dneg:
         stackPushDouble(-stackPopDouble());
         pc++;
         goto *opcodes[code[pc]];
     op_ishl: {
-        int32_t position = stackPopInt32();
-        int32_t value = stackPopInt32();
-        stackPushInt32(value << position);
+        int32_t *values = &stack[--sp];
+        values[0] = (int32_t)values[0] << values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1599,9 +1659,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_ishr: {
-        int32_t position = stackPopInt32();
-        int32_t value = stackPopInt32();
-        stackPushInt32(value >> position);
+        int32_t *values = &stack[--sp];
+        values[0] = (int32_t)values[0] >> values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1613,9 +1672,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_iushr: {
-        int32_t position = stackPopInt32();
-        uint32_t value = stackPopInt32();
-        stackPushInt32(value >> position);
+        int32_t *values = &stack[--sp];
+        values[0] = (uint32_t)values[0] >> values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1627,9 +1685,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_iand: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 & value2);
+        int32_t *values = &stack[--sp];
+        values[0] = values[0] & values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1641,9 +1698,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_ior: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 | value2);
+        int32_t *values = &stack[--sp];
+        values[0] = values[0] | values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1655,9 +1711,8 @@ void FExec::exec(bool initOpcodeLabels) {
         goto *opcodes[code[pc]];
     }
     op_ixor: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 ^ value2);
+        int32_t *values = &stack[--sp];
+        values[0] = values[0] ^ values[1];
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1770,75 +1825,75 @@ void FExec::exec(bool initOpcodeLabels) {
     }
     op_ifeq:
     op_ifnull:
-        pc += (!stackPopInt32()) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        pc += (!stackPopInt32()) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     op_ifne:
     op_ifnonnull:
-        pc += stackPopInt32() ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        pc += stackPopInt32() ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     op_iflt:
-        pc += (stackPopInt32() < 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        pc += (stackPopInt32() < 0) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     op_ifge:
-        pc += (stackPopInt32() >= 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        pc += (stackPopInt32() >= 0) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     op_ifgt:
-        pc += (stackPopInt32() > 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        pc += (stackPopInt32() > 0) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     op_ifle:
-        pc += (stackPopInt32() <= 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        pc += (stackPopInt32() <= 0) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     op_if_icmpeq:
     op_if_acmpeq: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 == value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        const int32_t *values = &stack[sp - 1];
+        sp -= 2;
+        pc += (values[0] == values[1]) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     }
     op_if_icmpne:
     op_if_acmpne: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 != value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        const int32_t *values = &stack[sp - 1];
+        sp -= 2;
+        pc += (values[0] != values[1]) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     }
     op_if_icmplt: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 < value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        const int32_t *values = &stack[sp - 1];
+        sp -= 2;
+        pc += (values[0] < values[1]) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     }
     op_if_icmpge: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 >= value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        const int32_t *values = &stack[sp - 1];
+        sp -= 2;
+        pc += (values[0] >= values[1]) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     }
     op_if_icmpgt: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 > value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        const int32_t *values = &stack[sp - 1];
+        sp -= 2;
+        pc += (values[0] > values[1]) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     }
     op_if_icmple: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 <= value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        const int32_t *values = &stack[sp - 1];
+        sp -= 2;
+        pc += (values[0] <= values[1]) ? CODE_INT16(&code[pc + 1]) : 3;
         goto *opcodes[code[pc]];
     }
     op_goto:
-        pc += ARRAY_TO_INT16(&code[pc + 1]);
+        pc += CODE_INT16(&code[pc + 1]);
         goto *opcodes[code[pc]];
     op_goto_w:
-        pc += ARRAY_TO_INT32(&code[pc + 1]);
+        pc += CODE_INT32(&code[pc + 1]);
         goto *opcodes[code[pc]];
     op_jsr:
         stackPushInt32(pc + 3);
-        pc += ARRAY_TO_INT16(&code[pc + 1]);
+        pc += CODE_INT16(&code[pc + 1]);
         goto *opcodes[code[pc]];
     op_jsrw:
         stackPushInt32(pc + 5);
-        pc += ARRAY_TO_INT32(&code[pc + 1]);
+        pc += CODE_INT32(&code[pc + 1]);
         goto *opcodes[code[pc]];
     op_ret:
         pc = locals[code[pc + 1]];
@@ -1847,35 +1902,50 @@ void FExec::exec(bool initOpcodeLabels) {
         int32_t index = stackPopInt32();
         uint8_t padding = (4 - ((pc + 1) % 4)) % 4;
         const uint8_t *table = &code[pc + padding + 1];
-        int32_t low = ARRAY_TO_INT32(&table[4]);
-        int32_t height = ARRAY_TO_INT32(&table[8]);
-        if(index < low || index > height) {
-            int32_t defaultOffset = ARRAY_TO_INT32(table);
-            pc += defaultOffset;
-            goto *opcodes[code[pc]];
-        }
-        table = &table[12 + (index - low) * 4];
-        pc += ARRAY_TO_INT32(table);
+        int32_t low = CODE_INT32(&table[4]);
+        int32_t height = CODE_INT32(&table[8]);
+        /* One unsigned compare covers both bounds */
+        uint32_t offset = (uint32_t)index - (uint32_t)low;
+        if(offset > (uint32_t)height - (uint32_t)low)
+            pc += CODE_INT32(table);
+        else
+            pc += CODE_INT32(&table[12 + offset * 4]);
         goto *opcodes[code[pc]];
     }
     op_lookupswitch: {
         int32_t key = stackPopInt32();
         uint8_t padding = (4 - ((pc + 1) % 4)) % 4;
         const uint8_t *table = &code[pc + padding + 1];
-        int32_t defaultPc = ARRAY_TO_INT32(table);
-        int32_t npairs = ARRAY_TO_INT32(&table[4]);
-        table = &table[8];
-        while(npairs--) {
-            int32_t pairs = ARRAY_TO_INT32(table);
-            if(key == pairs) {
-                pc += ARRAY_TO_INT32(&table[4]);
+        int32_t defaultPc = CODE_INT32(table);
+        int32_t npairs = CODE_INT32(&table[4]);
+        /* The pairs are sorted by key, the class loader makes sure of it */
+        const uint8_t *pairs = &table[8];
+        int32_t left = 0;
+        int32_t right = npairs - 1;
+        while(left <= right) {
+            int32_t mid = (left + right) >> 1;
+            int32_t match = CODE_INT32(&pairs[mid * 8]);
+            if(key == match) {
+                pc += CODE_INT32(&pairs[mid * 8 + 4]);
                 goto *opcodes[code[pc]];
             }
-            table = &table[8];
+            if(key < match) right = mid - 1;
+            else left = mid + 1;
         }
         pc += defaultPc;
         goto *opcodes[code[pc]];
     }
+    op_lookupswitch_dense: {
+        int32_t key = stackPopInt32();
+        uint8_t padding = (4 - ((pc + 1) % 4)) % 4;
+        const uint8_t *table = &code[pc + padding + 1];
+        uint32_t index = (uint32_t)key - (uint32_t)CODE_INT32(&table[8]);
+        if(index < (uint32_t)CODE_INT32(&table[4]))
+            pc += CODE_INT32(&table[12 + index * 8]);
+        else
+            pc += CODE_INT32(table);
+        goto *opcodes[code[pc]];
+    }
     op_ireturn:
     op_freturn: {
         int32_t retVal = stackPopInt32();
@@ -1922,23 +1992,28 @@ void FExec::exec(bool initOpcodeLabels) {
             constField->loader = clsLoader;
         }
         StaticInitStatus initStatus = clsLoader->getStaticInitStatus();
-        if(initStatus == INITIALIZED || (initStatus == INITIALIZING && clsLoader->monitorOwnId == (uint32_t)this)) {
+        if(initStatus == INITIALIZED || (initStatus == INITIALIZING && clsLoader->monitor.getOwner() == this)) {
             FieldValue *fieldValue = clsLoader->getStaticField(this, constField);
             if(fieldValue == NULL) goto exception_handler;
+            if(initStatus == INITIALIZED)
+                constField->staticValue = fieldValue;
             switch(constField->nameAndType->desc[0]) {
                 case 'J':
                 case 'D': {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_GETSTATIC, OP_GETSTATIC_WIDE_QUICK);
                     stackPushInt64(fieldValue->getInt64());
                     pc += 3;
                     goto *opcodes[code[pc]];
                 }
                 case 'L':
                 case '[': {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_GETSTATIC, OP_GETSTATIC_OBJ_QUICK);
                     stackPushObject(fieldValue->getObj());
                     pc += 3;
                     goto *opcodes[code[pc]];
                 }
                 default: {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_GETSTATIC, OP_GETSTATIC_QUICK);
                     stackPushInt32(fieldValue->getInt32());
                     pc += 3;
                     goto *opcodes[code[pc]];
@@ -1951,7 +2026,9 @@ void FExec::exec(bool initOpcodeLabels) {
             code = this->code;
             goto *opcodes[code[pc]];
         }
-        FlintAPI::Thread::yield();
+        /* Another thread is running <clinit>, block on the class monitor until it finishes */
+        if(lockClass(clsLoader)) unlockClass(clsLoader);
+        if(excp != NULL) goto exception_handler;
         if(FExec::hasTerminateRequest()) {
             // TODO - ERROR
             return;
@@ -1968,35 +2045,44 @@ void FExec::exec(bool initOpcodeLabels) {
             constField->loader = clsLoader;
         }
         StaticInitStatus initStatus = clsLoader->getStaticInitStatus();
-        if(initStatus == INITIALIZED || (initStatus == INITIALIZING && clsLoader->monitorOwnId == (uint32_t)this)) {
+        if(initStatus == INITIALIZED || (initStatus == INITIALIZING && clsLoader->monitor.getOwner() == this)) {
             FieldValue *fieldValue = clsLoader->getStaticField(this, constField);
             if(fieldValue == NULL) goto exception_handler;
+            if(initStatus == INITIALIZED)
+                constField->staticValue = fieldValue;
             switch(constField->nameAndType->desc[0]) {
                 case 'Z':
                 case 'B': {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_PUTSTATIC, OP_PUTSTATIC_BYTE_QUICK);
                     fieldValue->setInt32((int8_t)stackPopInt32());
                     pc += 3;
                     goto *opcodes[code[pc]];
                 }
                 case 'C':
                 case 'S': {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_PUTSTATIC, OP_PUTSTATIC_SHORT_QUICK);
                     fieldValue->setInt32((int16_t)stackPopInt32());
                     pc += 3;
                     goto *opcodes[code[pc]];
                 }
                 case 'J':
                 case 'D': {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_PUTSTATIC, OP_PUTSTATIC_WIDE_QUICK);
                     fieldValue->setInt64(stackPopInt64());
                     pc += 3;
                     goto *opcodes[code[pc]];
                 }
                 case 'L':
                 case '[': {
-                    fieldValue->setObj(stackPopObject());
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_PUTSTATIC, OP_PUTSTATIC_OBJ_QUICK);
+                    JObject *value = stackPopObject();
+                    fieldValue->setObj(value);
+                    flint->staticWriteBarrier(clsLoader, value);
                     pc += 3;
                     goto *opcodes[code[pc]];
                 }
                 default: {
+                    if(initStatus == INITIALIZED) Quicken(code, pc, OP_PUTSTATIC, OP_PUTSTATIC_QUICK);
                     fieldValue->setInt32(stackPopInt32());
                     pc += 3;
                     goto *opcodes[code[pc]];
@@ -2009,7 +2095,9 @@ void FExec::exec(bool initOpcodeLabels) {
             code = this->code;
             goto *opcodes[code[pc]];
         }
-        FlintAPI::Thread::yield();
+        /* Another thread is running <clinit>, block on the class monitor until it finishes */
+        if(lockClass(clsLoader)) unlockClass(clsLoader);
+        if(excp != NULL) goto exception_handler;
         if(FExec::hasTerminateRequest()) {
             // TODO - ERROR
             return;
@@ -2030,17 +2118,20 @@ void FExec::exec(bool initOpcodeLabels) {
         switch(constField->nameAndType->desc[0]) {
             case 'J':
             case 'D': {
+                Quicken(code, pc, OP_GETFIELD, OP_GETFIELD_WIDE_QUICK);
                 stackPushInt64(fieldValue->getInt64());
                 pc += 3;
                 goto *opcodes[code[pc]];
             }
             case 'L':
             case '[': {
+                Quicken(code, pc, OP_GETFIELD, OP_GETFIELD_OBJ_QUICK);
                 stackPushObject(fieldValue->getObj());
                 pc += 3;
                 goto *opcodes[code[pc]];
             }
             default: {
+                Quicken(code, pc, OP_GETFIELD, OP_GETFIELD_QUICK);
                 stackPushInt32(fieldValue->getInt32());
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -2062,6 +2153,7 @@ void FExec::exec(bool initOpcodeLabels) {
                 }
                 FieldValue *fieldValue = obj->getField(this, constField);
                 if(fieldValue == NULL) goto exception_handler;
+                Quicken(code, pc, OP_PUTFIELD, OP_PUTFIELD_BYTE_QUICK);
                 fieldValue->setInt32((int8_t)value);
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -2077,6 +2169,7 @@ void FExec::exec(bool initOpcodeLabels) {
                 }
                 FieldValue *fieldValue = obj->getField(this, constField);
                 if(fieldValue == NULL) goto exception_handler;
+                Quicken(code, pc, OP_PUTFIELD, OP_PUTFIELD_SHORT_QUICK);
                 fieldValue->setInt32((int16_t)value);
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -2092,6 +2185,7 @@ void FExec::exec(bool initOpcodeLabels) {
                 }
                 FieldValue *fieldValue = obj->getField(this, constField);
                 if(fieldValue == NULL) goto exception_handler;
+                Quicken(code, pc, OP_PUTFIELD, OP_PUTFIELD_WIDE_QUICK);
                 fieldValue->setInt64(value);
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -2107,7 +2201,9 @@ void FExec::exec(bool initOpcodeLabels) {
                 }
                 FieldValue *fieldValue = obj->getField(this, constField);
                 if(fieldValue == NULL) goto exception_handler;
+                Quicken(code, pc, OP_PUTFIELD, OP_PUTFIELD_OBJ_QUICK);
                 fieldValue->setObj(value);
+                flint->writeBarrier(this, obj, value);
                 pc += 3;
                 goto *opcodes[code[pc]];
             }
@@ -2121,6 +2217,7 @@ void FExec::exec(bool initOpcodeLabels) {
                 }
                 FieldValue *fieldValue = obj->getField(this, constField);
                 if(fieldValue == NULL) goto exception_handler;
+                Quicken(code, pc, OP_PUTFIELD, OP_PUTFIELD_QUICK);
                 fieldValue->setInt32(value);
                 pc += 3;
                 goto *opcodes[code[pc]];
@@ -2130,7 +2227,7 @@ void FExec::exec(bool initOpcodeLabels) {
     op_invokevirtual: {
         ConstMethod *constMethod = method->loader->getConstMethod(this, ARRAY_TO_INT16(&code[pc + 1]));
         if(constMethod == NULL) goto exception_handler;
-        invokeVirtual(constMethod);
+        invokeVirtual(constMethod, NULL);
         if(excp != NULL) goto exception_handler;
         code = this->code;
         goto *opcodes[code[pc]];
@@ -2155,11 +2252,339 @@ void FExec::exec(bool initOpcodeLabels) {
         ConstInterfaceMethod *interfaceMethod = method->loader->getConstInterfaceMethod(this, ARRAY_TO_INT16(&code[pc + 1]));
         if(interfaceMethod == NULL) goto exception_handler;
         uint8_t count = code[pc + 3];
-        invokeInterface(interfaceMethod, count);
+        invokeInterface(interfaceMethod, count, NULL);
+        if(excp != NULL) goto exception_handler;
+        code = this->code;
+        goto *opcodes[code[pc]];
+    }
+    op_invokevirtual_ic: {
+        InlineCache *cache = method->getInlineCache(ARRAY_TO_INT16(&code[pc + 1]));
+        ConstMethod *constMethod = method->loader->getConstMethod(this, cache->poolIndex);
+        if(constMethod == NULL) goto exception_handler;
+        invokeVirtual(constMethod, cache);
         if(excp != NULL) goto exception_handler;
         code = this->code;
         goto *opcodes[code[pc]];
     }
+    op_invokeinterface_ic: {
+        InlineCache *cache = method->getInlineCache(ARRAY_TO_INT16(&code[pc + 1]));
+        ConstInterfaceMethod *interfaceMethod = method->loader->getConstInterfaceMethod(this, cache->poolIndex);
+        if(interfaceMethod == NULL) goto exception_handler;
+        uint8_t count = code[pc + 3];
+        invokeInterface(interfaceMethod, count, cache);
+        if(excp != NULL) goto exception_handler;
+        code = this->code;
+        goto *opcodes[code[pc]];
+    }
+    op_ldc_quick: {
+        stackPushObject(method->loader->getConstObject(code[pc + 1]));
+        pc += 2;
+        goto *opcodes[code[pc]];
+    }
+    op_ldc_w_quick: {
+        stackPushObject(method->loader->getConstObject(ARRAY_TO_INT16(&code[pc + 1])));
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getstatic_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_getstatic;
+        stackPushInt32(fieldValue->getInt32());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getstatic_wide_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_getstatic;
+        stackPushInt64(fieldValue->getInt64());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getstatic_obj_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_getstatic;
+        stackPushObject(fieldValue->getObj());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putstatic_byte_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_putstatic;
+        fieldValue->setInt32((int8_t)stackPopInt32());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putstatic_short_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_putstatic;
+        fieldValue->setInt32((int16_t)stackPopInt32());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putstatic_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_putstatic;
+        fieldValue->setInt32(stackPopInt32());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putstatic_wide_quick: {
+        FieldValue *fieldValue = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]))->staticValue;
+        if(fieldValue == NULL) goto op_putstatic;
+        fieldValue->setInt64(stackPopInt64());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putstatic_obj_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        FieldValue *fieldValue = constField->staticValue;
+        if(fieldValue == NULL) goto op_putstatic;
+        JObject *value = stackPopObject();
+        fieldValue->setObj(value);
+        flint->staticWriteBarrier(constField->loader, value);
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getfield_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp];
+        if(obj == NULL) goto op_getfield;
+        sp--;
+        stackPushInt32(obj->getFieldByIndex(FIELD_SLOT(constField))->getInt32());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getfield_wide_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp];
+        if(obj == NULL) goto op_getfield;
+        sp--;
+        stackPushInt64(obj->getFieldByIndex(FIELD_SLOT(constField))->getInt64());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getfield_obj_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp];
+        if(obj == NULL) goto op_getfield;
+        sp--;
+        stackPushObject(obj->getFieldByIndex(FIELD_SLOT(constField))->getObj());
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putfield_byte_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp - 1];
+        if(obj == NULL) goto op_putfield;
+        obj->getFieldByIndex(FIELD_SLOT(constField))->setInt32((int8_t)stackPopInt32());
+        sp--;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putfield_short_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp - 1];
+        if(obj == NULL) goto op_putfield;
+        obj->getFieldByIndex(FIELD_SLOT(constField))->setInt32((int16_t)stackPopInt32());
+        sp--;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putfield_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp - 1];
+        if(obj == NULL) goto op_putfield;
+        obj->getFieldByIndex(FIELD_SLOT(constField))->setInt32(stackPopInt32());
+        sp--;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putfield_wide_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp - 2];
+        if(obj == NULL) goto op_putfield;
+        obj->getFieldByIndex(FIELD_SLOT(constField))->setInt64(stackPopInt64());
+        sp--;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_putfield_obj_quick: {
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp - 1];
+        if(obj == NULL) goto op_putfield;
+        JObject *value = stackPopObject();
+        obj->getFieldByIndex(FIELD_SLOT(constField))->setObj(value);
+        flint->writeBarrier(this, obj, value);
+        sp--;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_invokevirtual_quick: {
+        InlineCache *cache = method->getInlineCache(ARRAY_TO_INT16(&code[pc + 1]));
+        JObject *obj = (JObject *)stack[sp - cache->argc];
+        /* Null receivers, Class objects, unloaded/synchronized targets and class init all go through the _IC path */
+        if(obj == NULL || obj->type == NULL) goto op_invokevirtual_ic;
+        MethodInfo *methodInfo = obj->type->getClassLoader()->getVtableMethod(cache->tableIndex);
+        if(methodInfo == NULL || (methodInfo->accessFlag & (METHOD_UNLOADED | METHOD_ABSTRACT | METHOD_SYNCHRONIZED)))
+            goto op_invokevirtual_ic;
+        if(methodInfo->loader->getStaticInitStatus() == UNINITIALIZED) goto op_invokevirtual_ic;
+        lr = pc + 3;
+        invoke(methodInfo, cache->argc + 1);
+        if(excp != NULL) goto exception_handler;
+        code = this->code;
+        goto *opcodes[code[pc]];
+    }
+    op_invokestatic_quick: {
+        /* Only quickened for a resolved, unsynchronized target whose class is initialized */
+        ConstMethod *constMethod = method->loader->getConstMethod(this, ARRAY_TO_INT16(&code[pc + 1]));
+        lr = pc + 3;
+        invoke(constMethod->methodInfo, constMethod->getArgc());
+        if(excp != NULL) goto exception_handler;
+        code = this->code;
+        goto *opcodes[code[pc]];
+    }
+    op_invokespecial_quick: {
+        ConstMethod *constMethod = method->loader->getConstMethod(this, ARRAY_TO_INT16(&code[pc + 1]));
+        uint8_t argc = constMethod->getArgc();
+        /* A null receiver throws from the full path */
+        if((JObject *)stack[sp - argc] == NULL) goto op_invokespecial;
+        lr = pc + 3;
+        invoke(constMethod->methodInfo, argc + 1);
+        if(excp != NULL) goto exception_handler;
+        code = this->code;
+        goto *opcodes[code[pc]];
+    }
+    /*
+     * Superinstructions run the whole sequence when the instructions after the first one are still the ones the class
+     * loader saw (a breakpoint or a getfield that is not quickened yet changes them) and the debugger is not stepping.
+     * Otherwise, or when the sequence would throw, they run only the first instruction
+     */
+    op_aload_0_getfield: {
+        JObject *obj = (JObject *)locals[0];
+        uint8_t op = code[pc + 1];
+        if(obj == NULL || opcodes != (const void **)opcodeLabels) goto op_aload_0;
+        if(op != OP_GETFIELD_QUICK && op != OP_GETFIELD_OBJ_QUICK) goto op_aload_0;
+        ConstField *constField = method->loader->getConstField(this, ARRAY_TO_INT16(&code[pc + 2]));
+        FieldValue *fieldValue = obj->getFieldByIndex(FIELD_SLOT(constField));
+        if(op == OP_GETFIELD_OBJ_QUICK)
+            stackPushObject(fieldValue->getObj());
+        else
+            stackPushInt32(fieldValue->getInt32());
+        pc += 4;
+        goto *opcodes[code[pc]];
+    }
+    op_iload_iload_iadd:
+        fusedLocal = code[pc + 1];
+        fusedNext = pc + 2;
+        goto iload_iload_iadd;
+    op_iload_0_iload_iadd:
+        fusedLocal = 0;
+        fusedNext = pc + 1;
+        goto iload_iload_iadd;
+    op_iload_1_iload_iadd:
+        fusedLocal = 1;
+        fusedNext = pc + 1;
+        goto iload_iload_iadd;
+    op_iload_2_iload_iadd:
+        fusedLocal = 2;
+        fusedNext = pc + 1;
+        goto iload_iload_iadd;
+    op_iload_3_iload_iadd:
+        fusedLocal = 3;
+        fusedNext = pc + 1;
+    iload_iload_iadd: {
+        uint32_t next = fusedNext;
+        uint8_t op = code[next];
+        uint32_t index;
+        if(opcodes != (const void **)opcodeLabels) goto fused_iload;
+        if(op == OP_ILOAD) { index = code[next + 1]; next += 2; }
+        else if(op >= OP_ILOAD_0 && op <= OP_ILOAD_3) { index = op - OP_ILOAD_0; next++; }
+        else goto fused_iload;
+        if(code[next] != OP_IADD) goto fused_iload;
+        stackPushInt32(locals[fusedLocal] + locals[index]);
+        pc = next + 1;
+        goto *opcodes[code[pc]];
+    }
+    op_iload_iconst_if_icmp:
+        fusedLocal = code[pc + 1];
+        fusedNext = pc + 2;
+        goto iload_iconst_if_icmp;
+    op_iload_0_iconst_if_icmp:
+        fusedLocal = 0;
+        fusedNext = pc + 1;
+        goto iload_iconst_if_icmp;
+    op_iload_1_iconst_if_icmp:
+        fusedLocal = 1;
+        fusedNext = pc + 1;
+        goto iload_iconst_if_icmp;
+    op_iload_2_iconst_if_icmp:
+        fusedLocal = 2;
+        fusedNext = pc + 1;
+        goto iload_iconst_if_icmp;
+    op_iload_3_iconst_if_icmp:
+        fusedLocal = 3;
+        fusedNext = pc + 1;
+    iload_iconst_if_icmp: {
+        uint32_t next = fusedNext;
+        uint8_t op = code[next];
+        int32_t value1 = locals[fusedLocal];
+        int32_t value2;
+        bool isTaken;
+        if(opcodes != (const void **)opcodeLabels) goto fused_iload;
+        if(op >= OP_ICONST_M1 && op <= OP_ICONST_5) { value2 = (int32_t)op - OP_ICONST_0; next++; }
+        else if(op == OP_BIPUSH) { value2 = (int8_t)code[next + 1]; next += 2; }
+        else goto fused_iload;
+        switch(code[next]) {
+            case OP_IF_ICMPEQ: isTaken = (value1 == value2); break;
+            case OP_IF_ICMPNE: isTaken = (value1 != value2); break;
+            case OP_IF_ICMPLT: isTaken = (value1 < value2); break;
+            case OP_IF_ICMPGE: isTaken = (value1 >= value2); break;
+            case OP_IF_ICMPGT: isTaken = (value1 > value2); break;
+            case OP_IF_ICMPLE: isTaken = (value1 <= value2); break;
+            default: goto fused_iload;
+        }
+        pc = isTaken ? (next + CODE_INT16(&code[next + 1])) : (next + 3);
+        goto *opcodes[code[pc]];
+    }
+    fused_iload:
+        stackPushInt32(locals[fusedLocal]);
+        pc = fusedNext;
+        goto *opcodes[code[pc]];
+    op_aload_arraylength:
+        fusedLocal = code[pc + 1];
+        fusedNext = pc + 2;
+        goto aload_arraylength;
+    op_aload_0_arraylength:
+        fusedLocal = 0;
+        fusedNext = pc + 1;
+        goto aload_arraylength;
+    op_aload_1_arraylength:
+        fusedLocal = 1;
+        fusedNext = pc + 1;
+        goto aload_arraylength;
+    op_aload_2_arraylength:
+        fusedLocal = 2;
+        fusedNext = pc + 1;
+        goto aload_arraylength;
+    op_aload_3_arraylength:
+        fusedLocal = 3;
+        fusedNext = pc + 1;
+    aload_arraylength: {
+        JObject *obj = (JObject *)locals[fusedLocal];
+        if(obj == NULL || code[fusedNext] != OP_ARRAYLENGTH || opcodes != (const void **)opcodeLabels) {
+            stackPushObject(obj);
+            pc = fusedNext;
+            goto *opcodes[code[pc]];
+        }
+        stackPushInt32(obj->size / obj->type->componentSize());
+        pc = fusedNext + 1;
+        goto *opcodes[code[pc]];
+    }
+    op_iinc_goto:
+        if(code[pc + 3] != OP_GOTO || opcodes != (const void **)opcodeLabels) goto op_iinc;
+        locals[code[pc + 1]] += (int8_t)code[pc + 2];
+        pc += 3 + CODE_INT16(&code[pc + 4]);
+        goto *opcodes[code[pc]];
     op_invokedynamic: {
         // TODO
         // goto *opcodes[code[pc]];
@@ -2314,7 +2739,6 @@ void FExec::exec(bool initOpcodeLabels) {
         }
         if(lockObject(obj) == false) {
             if(excp != NULL) goto exception_handler;
-            FlintAPI::Thread::yield();
             goto *opcodes[code[pc]];
         }
         stackPopObject();
@@ -2535,6 +2959,7 @@ void FExec::vThrowNew(JClass *cls, const char *msg, va_list args) {
         obj->setDetailMessage(str);
     }
     obj->setCause(excp != NULL ? excp : obj);
+    flint->writeBarrier(this, obj, excp);
     excp = obj;
 }
 
@@ -2549,6 +2974,7 @@ void FExec::stopRequest(void) {
 void FExec::terminateRequest(void) {
     opcodes = opcodeLabelsExit;
     FlintAPI::Thread::notify(getOwnerThread()->getHandle(), -1);
+    FlintAPI::Thread::unpark(getOwnerThread()->getHandle());
 }
 
 jbool FExec::hasTerminateRequest(void) {
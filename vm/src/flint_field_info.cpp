@@ -4,6 +4,10 @@
 #include "flint_field_info.h"
 
 FieldInfo::FieldInfo(FieldAccessFlag accessFlag, const char *name, const char *desc) :
-accessFlag(accessFlag), name(name), desc(desc), hash((Hash(name) & 0xFFFF) | (Hash(desc) << 16)) {
+accessFlag(accessFlag), slot(0), name(name), desc(desc), hash((Hash(name) & 0xFFFF) | (Hash(desc) << 16)) {
 
 }
+
+uint16_t FieldInfo::getSlot(void) const {
+    return slot;
+}
@@ -0,0 +1,28 @@
+
+#include <string.h>
+#include "flint_common.h"
+#include "flint_file_dict_node.h"
+
+FileDictNode::FileDictNode(const char *path, FlintAPI::IO::FileHandle handle) : DictNode(), hash(Hash(path)), handle(handle) {
+    strcpy(this->path, path);
+}
+
+uint32_t FileDictNode::getHashKey(void) const {
+    return hash;
+}
+
+int32_t FileDictNode::compareKey(const char *key, uint16_t length) const {
+    return strncmp(path, key, length);
+}
+
+int32_t FileDictNode::compareKey(DictNode *other) const {
+    return strcmp(path, ((FileDictNode *)other)->path);
+}
+
+const char *FileDictNode::getPath(void) const {
+    return path;
+}
+
+FlintAPI::IO::FileHandle FileDictNode::getHandle(void) const {
+    return handle;
+}
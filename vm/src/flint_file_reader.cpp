@@ -1,4 +1,5 @@
 
+#include <string.h>
 #include "flint.h"
 #include "flint_file_reader.h"
 
@@ -40,44 +41,90 @@ static const char *GetName(const char *filePath) {
     return name;
 }
 
-FileReader::FileReader(void) : handle(NULL), ctx(NULL), filePath(NULL) {
+FileReader::FileReader(void) :
+flint(NULL), handle(NULL), ctx(NULL), filePath(NULL), position(0), buffOffset(0), buffLength(0) {
 
 }
 
-FileReader::FileReader(FExec *ctx, const char *filePath) :
-handle(NULL), ctx(ctx), filePath(filePath) {
+FileReader::FileReader(Flint *flint, FExec *ctx, const char *filePath) :
+flint(flint), handle(NULL), ctx(ctx), filePath(filePath), position(0), buffOffset(0), buffLength(0) {
 
 }
 
 bool FileReader::open(void) {
     if(handle == NULL) {
-        handle = FlintAPI::IO::fopen(filePath, FlintAPI::IO::FILE_MODE_READ);
+        /* The handle is owned by Flint and stays open until freeAll, so reopening the same jar is cheap */
+        handle = flint->getFileHandle(filePath);
         if(handle == NULL && ctx != NULL)
             ctx->throwNew(ctx->getFlint()->findClass(ctx, "java/io/IOException"), "Failed to open file %s", GetName(filePath));
+        position = 0;
+        buffLength = 0;
         return handle != NULL;
     }
     return true;
 }
 
 bool FileReader::close(void) {
-    if(FlintAPI::IO::fclose(handle) != FlintAPI::IO::FILE_RESULT_OK) {
-        if(ctx != NULL)
-            ctx->throwNew(ctx->getFlint()->findClass(ctx, "java/io/IOException"), "FlintAPI::IO::fclose failed");
-        return false;
-    }
     handle = NULL;
+    buffLength = 0;
     return true;
 }
 
-int32_t FileReader::read(void *buff, uint32_t size) {
-    uint32_t temp;
-    FlintAPI::IO::FileResult ret = FlintAPI::IO::fread(handle, buff, size, &temp);
-    if(ret != FlintAPI::IO::FILE_RESULT_OK) {
+int32_t FileReader::fetch(uint32_t offset, uint8_t *dst, uint32_t size) {
+    uint32_t br;
+    /* The handle is shared by every reader of the file, its file pointer can not be trusted */
+    if(
+        FlintAPI::IO::fseek(handle, offset) != FlintAPI::IO::FILE_RESULT_OK ||
+        FlintAPI::IO::fread(handle, dst, size, &br) != FlintAPI::IO::FILE_RESULT_OK
+    ) {
         if(ctx != NULL)
             ctx->throwNew(ctx->getFlint()->findClass(ctx, "java/io/IOException"), "FlintAPI::IO::fread failed");
         return -1;
     }
-    return temp;
+    return br;
+}
+
+void FileReader::discardBuffer(void) {
+    buffLength = 0;
+}
+
+bool FileReader::fill(void) {
+    int32_t br = fetch(position, buff, sizeof(buff));
+    if(br < 0) {
+        buffLength = 0;
+        return false;
+    }
+    buffOffset = position;
+    buffLength = br;
+    return true;
+}
+
+int32_t FileReader::read(void *data, uint32_t size) {
+    uint8_t *dst = (uint8_t *)data;
+    uint32_t count = 0;
+    while(count < size) {
+        uint32_t remain = size - count;
+        if(position >= buffOffset && position < (buffOffset + buffLength)) {
+            uint32_t len = buffOffset + buffLength - position;
+            if(len > remain) len = remain;
+            memcpy(&dst[count], &buff[position - buffOffset], len);
+            position += len;
+            count += len;
+        }
+        else if(remain >= sizeof(buff)) {
+            /* Reads larger than the buffer go straight to the destination */
+            int32_t br = fetch(position, &dst[count], remain);
+            if(br < 0) return -1;
+            position += br;
+            count += br;
+            break;
+        }
+        else {
+            if(!fill()) return -1;
+            if(buffLength == 0) break;
+        }
+    }
+    return count;
 }
 
 bool FileReader::readUInt8(uint8_t &value) {
@@ -134,26 +181,32 @@ int32_t FileReader::readLine(char *buff, uint32_t size) {
 }
 
 uint32_t FileReader::tell(void) {
-    return FlintAPI::IO::ftell(handle);
+    return position;
 }
 
 bool FileReader::seek(int32_t offset) {
-    if(FlintAPI::IO::fseek(handle, offset) != FlintAPI::IO::FILE_RESULT_OK) {
+    /* Only the logical position moves, the next read that misses the buffer seeks the file */
+    if(offset < 0) {
         if(ctx != NULL)
             ctx->throwNew(ctx->getFlint()->findClass(ctx, "java/io/IOException"), "FlintAPI::IO::fseek failed");
         return false;
     }
+    position = offset;
     return true;
 }
 
 bool FileReader::offset(int32_t offset) {
-    return seek(tell() + offset);
+    return seek(position + offset);
 }
 
 uint32_t FileReader::size(void) {
     return FlintAPI::IO::fsize(handle);
 }
 
+bool FileReader::isCompressed(void) const {
+    return false;
+}
+
 const char *FileReader::getFilePath(void) {
     return filePath;
 }
@@ -0,0 +1,206 @@
+
+#include "flint_heap.h"
+#include "flint_system_api.h"
+
+static const uint16_t sizeClasses[HEAP_SIZE_CLASS_COUNT] = {
+    8, 16, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256
+};
+
+/* Size class index by (size + 7) / 8 */
+static const uint8_t sizeClassIndex[HEAP_MAX_SMALL_SIZE / 8 + 1] = {
+    0, 0, 1, 2, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9, 9, 9, 9,
+    10, 10, 10, 10, 11, 11, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12
+};
+
+FHeap::FHeap(void) : regionStart(NULL), regionTop(NULL), regionFailed(false) {
+    for(uint32_t i = 0; i < HEAP_SIZE_CLASS_COUNT; i++)
+        partialPages[i] = NULL;
+    for(uint32_t i = 0; i < sizeof(pageMap) / sizeof(pageMap[0]); i++)
+        pageMap[i] = 0;
+}
+
+bool FHeap::initRegion(void) {
+    if(regionFailed || HEAP_SLAB_REGION_SIZE < HEAP_PAGE_SIZE) return false;
+    /* One extra page so that the pages can be aligned to HEAP_PAGE_SIZE */
+    uint8_t *region = (uint8_t *)FlintAPI::System::malloc(HEAP_SLAB_REGION_SIZE + HEAP_PAGE_SIZE);
+    if(region == NULL) {
+        regionFailed = true;
+        return false;
+    }
+    regionStart = (uint8_t *)(((uint32_t)region + HEAP_PAGE_SIZE - 1) & ~(HEAP_PAGE_SIZE - 1));
+    regionTop = regionStart;
+    return true;
+}
+
+/* Index of the lowest run of count free pages, -1 if there is none */
+int32_t FHeap::findFreePages(uint32_t count) const {
+    uint32_t run = 0;
+    for(uint32_t i = 0; i < HEAP_PAGE_COUNT; i++) {
+        uint32_t bits = pageMap[i / 32];
+        if(bits == 0xFFFFFFFF) {
+            run = 0;
+            i |= 31;
+        }
+        else if(bits & (1U << (i % 32)))
+            run = 0;
+        else if(++run == count)
+            return i + 1 - count;
+    }
+    return -1;
+}
+
+void FHeap::setPages(uint32_t index, uint32_t count, bool inUse) {
+    for(uint32_t i = index; i < index + count; i++) {
+        if(inUse)
+            pageMap[i / 32] |= 1U << (i % 32);
+        else
+            pageMap[i / 32] &= ~(1U << (i % 32));
+    }
+}
+
+HeapPage *FHeap::takePages(uint32_t count) {
+    if(regionStart == NULL && !initRegion()) return NULL;
+    int32_t index = findFreePages(count);
+    if(index < 0) return NULL;
+    setPages(index, count, true);
+    uint8_t *page = regionStart + index * HEAP_PAGE_SIZE;
+    if(page + count * HEAP_PAGE_SIZE > regionTop)
+        regionTop = page + count * HEAP_PAGE_SIZE;
+    return (HeapPage *)page;
+}
+
+HeapPage *FHeap::newPage(uint8_t sizeClass) {
+    HeapPage *page = takePages(1);
+    if(page == NULL) return NULL;
+    uint32_t blockSize = sizeClasses[sizeClass];
+    uint8_t *block = (uint8_t *)page + sizeof(HeapPage);
+    uint8_t *end = (uint8_t *)page + HEAP_PAGE_SIZE - blockSize;
+    void **tail = &page->freeList;
+    for(; block <= end; block += blockSize) {
+        *tail = block;
+        tail = (void **)block;
+    }
+    *tail = NULL;
+    page->used = 0;
+    page->sizeClass = sizeClass;
+    linkPage(&partialPages[sizeClass], page);
+    return page;
+}
+
+HeapPage *FHeap::getPage(const void *p) const {
+    return (HeapPage *)((uint32_t)p & ~(HEAP_PAGE_SIZE - 1));
+}
+
+void *FHeap::alloc(uint32_t size) {
+    if(size > HEAP_MAX_SMALL_SIZE) return NULL;
+    uint8_t sizeClass = sizeClassIndex[(size + 7) / 8];
+    HeapPage *page = partialPages[sizeClass];
+    if(page == NULL) {
+        page = newPage(sizeClass);
+        if(page == NULL) return NULL;
+    }
+    void *p = page->freeList;
+    page->freeList = *(void **)p;
+    page->used++;
+    if(page->freeList == NULL)
+        unlinkPage(&partialPages[sizeClass], page);
+    return p;
+}
+
+/* Takes up to maxCount blocks of one page at once, returned as a list linked through their first word */
+void *FHeap::allocBatch(uint8_t sizeClass, uint32_t maxCount, uint32_t *count) {
+    HeapPage *page = partialPages[sizeClass];
+    if(page == NULL) {
+        page = newPage(sizeClass);
+        if(page == NULL) {
+            *count = 0;
+            return NULL;
+        }
+    }
+    void *list = page->freeList;
+    void **tail = &page->freeList;
+    uint32_t n = 0;
+    while(n < maxCount && *tail != NULL) {
+        tail = (void **)*tail;
+        n++;
+    }
+    page->freeList = *tail;
+    *tail = NULL;
+    page->used += n;
+    if(page->freeList == NULL)
+        unlinkPage(&partialPages[sizeClass], page);
+    *count = n;
+    return list;
+}
+
+/* Places a block of any size on a run of free pages, for when the system heap is too fragmented */
+void *FHeap::allocLarge(uint32_t size) {
+    uint32_t pageCount = (size + sizeof(HeapPage) + HEAP_PAGE_SIZE - 1) / HEAP_PAGE_SIZE;
+    if(pageCount > HEAP_PAGE_COUNT) return NULL;
+    HeapPage *page = takePages(pageCount);
+    if(page == NULL) return NULL;
+    page->freeList = NULL;
+    page->used = pageCount;
+    page->sizeClass = HEAP_LARGE_CLASS;
+    return (uint8_t *)page + sizeof(HeapPage);
+}
+
+bool FHeap::free(void *p) {
+    if(!contains(p)) return false;
+    HeapPage *page = getPage(p);
+    uint32_t index = ((uint8_t *)page - regionStart) / HEAP_PAGE_SIZE;
+    if(page->sizeClass == HEAP_LARGE_CLASS) {
+        setPages(index, page->used, false);
+        return true;
+    }
+    bool wasFull = (page->freeList == NULL);
+    *(void **)p = page->freeList;
+    page->freeList = p;
+    page->used--;
+    if(page->used == 0) {
+        /* Empty pages go back to the region so any size class can reuse them */
+        if(!wasFull) unlinkPage(&partialPages[page->sizeClass], page);
+        setPages(index, 1, false);
+    }
+    else if(wasFull)
+        linkPage(&partialPages[page->sizeClass], page);
+    return true;
+}
+
+bool FHeap::contains(const void *p) const {
+    return (regionStart <= (const uint8_t *)p) && ((const uint8_t *)p < regionTop);
+}
+
+uint32_t FHeap::getBlockSize(const void *p) const {
+    if(!contains(p)) return 0;
+    HeapPage *page = getPage(p);
+    if(page->sizeClass == HEAP_LARGE_CLASS)
+        return page->used * HEAP_PAGE_SIZE - sizeof(HeapPage);
+    return sizeClasses[page->sizeClass];
+}
+
+int32_t FHeap::getSizeClass(uint32_t size) {
+    return (size <= HEAP_MAX_SMALL_SIZE) ? sizeClassIndex[(size + 7) / 8] : -1;
+}
+
+uint32_t FHeap::getClassSize(uint8_t sizeClass) {
+    return sizeClasses[sizeClass];
+}
+
+void FHeap::linkPage(HeapPage **list, HeapPage *page) {
+    page->prev = NULL;
+    page->next = *list;
+    if(*list != NULL)
+        (*list)->prev = page;
+    *list = page;
+}
+
+void FHeap::unlinkPage(HeapPage **list, HeapPage *page) {
+    if(page->prev != NULL)
+        page->prev->next = page->next;
+    else
+        *list = page->next;
+    if(page->next != NULL)
+        page->next->prev = page->prev;
+    page->prev = page->next = NULL;
+}
@@ -0,0 +1,58 @@
+
+#include <string.h>
+#include "flint_heap_dump.h"
+
+HeapDumpWriter::HeapDumpWriter(void) : handle(NULL), buffLength(0), error(false) {
+
+}
+
+bool HeapDumpWriter::open(const char *path) {
+    handle = FlintAPI::IO::fopen(path, (FlintAPI::IO::FileMode)(FlintAPI::IO::FILE_MODE_WRITE | FlintAPI::IO::FILE_MODE_CREATE_ALWAYS));
+    buffLength = 0;
+    error = (handle == NULL);
+    return handle != NULL;
+}
+
+void HeapDumpWriter::flush(void) {
+    if(buffLength == 0 || error) return;
+    uint32_t bw;
+    if(FlintAPI::IO::fwrite(handle, buff, buffLength, &bw) != FlintAPI::IO::FILE_RESULT_OK || bw != buffLength)
+        error = true;
+    buffLength = 0;
+}
+
+bool HeapDumpWriter::close(void) {
+    if(handle == NULL) return false;
+    flush();
+    if(FlintAPI::IO::fclose(handle) != FlintAPI::IO::FILE_RESULT_OK)
+        error = true;
+    handle = NULL;
+    return !error;
+}
+
+void HeapDumpWriter::write(const void *data, uint32_t size) {
+    const uint8_t *src = (const uint8_t *)data;
+    while(size > 0 && !error) {
+        if(buffLength == sizeof(buff)) flush();
+        uint32_t count = sizeof(buff) - buffLength;
+        if(count > size) count = size;
+        memcpy(&buff[buffLength], src, count);
+        buffLength += count;
+        src += count;
+        size -= count;
+    }
+}
+
+void HeapDumpWriter::writeUInt8(uint8_t value) {
+    write(&value, sizeof(value));
+}
+
+void HeapDumpWriter::writeUInt16(uint16_t value) {
+    uint8_t data[] = {(uint8_t)value, (uint8_t)(value >> 8)};
+    write(data, sizeof(data));
+}
+
+void HeapDumpWriter::writeUInt32(uint32_t value) {
+    uint8_t data[] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    write(data, sizeof(data));
+}
@@ -0,0 +1,346 @@
+
+#include <new>
+#include <string.h>
+#include "flint.h"
+#include "flint_inflater.h"
+
+#define INFLATE_BLOCK_HEADER        0
+#define INFLATE_STORED              1
+#define INFLATE_HUFFMAN             2
+#define INFLATE_DONE                3
+#define INFLATE_ERROR               4
+
+static const uint16_t lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t lengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t distBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const uint8_t distExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static const uint8_t codeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static uint32_t Reverse16(uint32_t value) {
+    value = ((value & 0xAAAA) >> 1) | ((value & 0x5555) << 1);
+    value = ((value & 0xCCCC) >> 2) | ((value & 0x3333) << 2);
+    value = ((value & 0xF0F0) >> 4) | ((value & 0x0F0F) << 4);
+    value = ((value & 0xFF00) >> 8) | ((value & 0x00FF) << 8);
+    return value;
+}
+
+Inflater::Inflater(FlintAPI::IO::FileHandle handle, uint32_t offset, uint32_t compressedSize, uint32_t windowSize) :
+handle(handle), srcOffset(offset), srcSize(compressedSize), windowMask(windowSize - 1) {
+    reset();
+}
+
+Inflater *Inflater::create(Flint *flint, FExec *ctx, FlintAPI::IO::FileHandle handle, uint32_t offset, uint32_t compressedSize, uint32_t size) {
+    /* A match can not reach further back than the start of the entry, small entries need less than the full 32KB window */
+    uint32_t windowSize = 1;
+    while(windowSize < size && windowSize < INFLATE_MAX_WINDOW_SIZE)
+        windowSize <<= 1;
+    Inflater *inflater = (Inflater *)flint->malloc(ctx, sizeof(Inflater) + windowSize);
+    if(inflater == NULL) return NULL;
+    new (inflater)Inflater(handle, offset, compressedSize, windowSize);
+    return inflater;
+}
+
+void Inflater::reset(void) {
+    srcPosition = 0;
+    outPosition = 0;
+    bitBuff = 0;
+    bitCount = 0;
+    padding = 0;
+    storedLength = 0;
+    copyLength = 0;
+    copyDistance = 0;
+    inPosition = 0;
+    inLength = 0;
+    state = INFLATE_BLOCK_HEADER;
+    lastBlock = false;
+}
+
+uint8_t Inflater::nextByte(void) {
+    if(inPosition >= inLength) {
+        uint32_t remain = srcSize - srcPosition;
+        uint32_t br;
+        if(remain == 0) {
+            /* Past the end of the entry, counted so that consuming these bits can be detected */
+            padding++;
+            return 0;
+        }
+        if(remain > sizeof(inBuff)) remain = sizeof(inBuff);
+        /* The handle is shared with the reader, seek every time */
+        if(
+            FlintAPI::IO::fseek(handle, srcOffset + srcPosition) != FlintAPI::IO::FILE_RESULT_OK ||
+            FlintAPI::IO::fread(handle, inBuff, remain, &br) != FlintAPI::IO::FILE_RESULT_OK ||
+            br == 0
+        ) {
+            /* Treated as a truncated entry, inflate fails as soon as the missing bits are used */
+            srcSize = srcPosition;
+            padding++;
+            return 0;
+        }
+        srcPosition += br;
+        inPosition = 0;
+        inLength = br;
+    }
+    return inBuff[inPosition++];
+}
+
+void Inflater::fillBits(void) {
+    while(bitCount <= 24) {
+        bitBuff |= (uint32_t)nextByte() << bitCount;
+        bitCount += 8;
+    }
+}
+
+uint32_t Inflater::getBits(uint32_t count) {
+    if(bitCount < count) fillBits();
+    uint32_t value = bitBuff & ((1 << count) - 1);
+    bitBuff >>= count;
+    bitCount -= count;
+    return value;
+}
+
+int32_t Inflater::decode(const InflateTable *table) {
+    if(bitCount < 16) fillBits();
+    uint32_t fast = table->fast[bitBuff & ((1 << INFLATE_FAST_BITS) - 1)];
+    if(fast) {
+        uint32_t len = fast >> 9;
+        bitBuff >>= len;
+        bitCount -= len;
+        return fast & 0x1FF;
+    }
+    /* Codes longer than INFLATE_FAST_BITS are found by comparing the bit reversed input against each length */
+    uint32_t code = Reverse16(bitBuff & 0xFFFF);
+    uint32_t len;
+    for(len = INFLATE_FAST_BITS + 1; len < 16; len++) {
+        if(code < table->maxCode[len]) break;
+    }
+    if(len >= 16) return -1;
+    uint32_t index = (code >> (16 - len)) - table->firstCode[len] + table->firstSymbol[len];
+    if(index >= 288) return -1;
+    bitBuff >>= len;
+    bitCount -= len;
+    return table->symbols[index];
+}
+
+bool Inflater::buildTable(InflateTable *table, const uint8_t *lengths, uint16_t count) {
+    uint16_t sizes[16];
+    uint16_t nextCode[16];
+    memset(sizes, 0, sizeof(sizes));
+    memset(table->fast, 0, sizeof(table->fast));
+    for(uint16_t i = 0; i < count; i++)
+        sizes[lengths[i]]++;
+    sizes[0] = 0;
+    uint32_t code = 0;
+    uint32_t symbol = 0;
+    for(uint32_t len = 1; len < 16; len++) {
+        nextCode[len] = code;
+        table->firstCode[len] = code;
+        table->firstSymbol[len] = symbol;
+        code += sizes[len];
+        if(sizes[len] && (code - 1) >= (1U << len)) return false;
+        table->maxCode[len] = code << (16 - len);
+        code <<= 1;
+        symbol += sizes[len];
+    }
+    table->maxCode[16] = 0x10000;
+    for(uint16_t i = 0; i < count; i++) {
+        uint32_t len = lengths[i];
+        if(len == 0) continue;
+        table->symbols[nextCode[len] - table->firstCode[len] + table->firstSymbol[len]] = i;
+        if(len <= INFLATE_FAST_BITS) {
+            uint16_t fast = (len << 9) | i;
+            for(uint32_t j = Reverse16(nextCode[len]) >> (16 - len); j < (1 << INFLATE_FAST_BITS); j += 1 << len)
+                table->fast[j] = fast;
+        }
+        nextCode[len]++;
+    }
+    return true;
+}
+
+bool Inflater::readDynamicTables(void) {
+    uint8_t lengths[288 + 32];
+    uint8_t codeLengths[19];
+    uint32_t litCount = getBits(5) + 257;
+    uint32_t distCount = getBits(5) + 1;
+    uint32_t codeLengthCount = getBits(4) + 4;
+    if(litCount > 288 || distCount > 32) return false;
+
+    memset(codeLengths, 0, sizeof(codeLengths));
+    for(uint32_t i = 0; i < codeLengthCount; i++)
+        codeLengths[codeLengthOrder[i]] = getBits(3);
+    if(!buildTable(&lenTable, codeLengths, sizeof(codeLengths))) return false;
+
+    uint32_t total = litCount + distCount;
+    uint32_t count = 0;
+    while(count < total) {
+        int32_t sym = decode(&lenTable);
+        if(sym < 0) return false;
+        if(sym < 16) {
+            lengths[count++] = sym;
+            continue;
+        }
+        uint8_t value = 0;
+        uint32_t repeat;
+        if(sym == 16) {
+            if(count == 0) return false;
+            value = lengths[count - 1];
+            repeat = 3 + getBits(2);
+        }
+        else if(sym == 17)
+            repeat = 3 + getBits(3);
+        else
+            repeat = 11 + getBits(7);
+        if(count + repeat > total) return false;
+        memset(&lengths[count], value, repeat);
+        count += repeat;
+    }
+    if(lengths[256] == 0) return false;
+    return buildTable(&lenTable, lengths, litCount) && buildTable(&distTable, &lengths[litCount], distCount);
+}
+
+bool Inflater::readBlockHeader(void) {
+    lastBlock = getBits(1);
+    switch(getBits(2)) {
+        case 0: {
+            getBits(bitCount & 0x07);
+            uint32_t len = getBits(16);
+            uint32_t nlen = getBits(16);
+            if((len ^ 0xFFFF) != nlen) return false;
+            storedLength = len;
+            state = INFLATE_STORED;
+            return true;
+        }
+        case 1: {
+            uint8_t lengths[288];
+            memset(&lengths[0], 8, 144);
+            memset(&lengths[144], 9, 112);
+            memset(&lengths[256], 7, 24);
+            memset(&lengths[280], 8, 8);
+            if(!buildTable(&lenTable, lengths, 288)) return false;
+            memset(lengths, 5, 30);
+            if(!buildTable(&distTable, lengths, 30)) return false;
+            state = INFLATE_HUFFMAN;
+            return true;
+        }
+        case 2:
+            if(!readDynamicTables()) return false;
+            state = INFLATE_HUFFMAN;
+            return true;
+        default:
+            return false;
+    }
+}
+
+int32_t Inflater::inflate(uint8_t *dst, uint32_t size) {
+    uint8_t *win = window;
+    uint32_t mask = windowMask;
+    uint32_t count = 0;
+    while(count < size) {
+        if(copyLength) {
+            uint32_t len = copyLength;
+            if(len > (size - count)) len = size - count;
+            copyLength -= len;
+            uint32_t from = outPosition - copyDistance;
+            while(len--) {
+                uint8_t value = win[from++ & mask];
+                win[outPosition++ & mask] = value;
+                dst[count++] = value;
+            }
+            continue;
+        }
+        switch(state) {
+            case INFLATE_BLOCK_HEADER:
+                if(lastBlock)
+                    state = INFLATE_DONE;
+                else if(!readBlockHeader())
+                    state = INFLATE_ERROR;
+                break;
+            case INFLATE_STORED:
+                if(storedLength == 0) {
+                    state = INFLATE_BLOCK_HEADER;
+                    break;
+                }
+                while(storedLength && count < size) {
+                    uint8_t value = (uint8_t)getBits(8);
+                    win[outPosition++ & mask] = value;
+                    dst[count++] = value;
+                    storedLength--;
+                }
+                break;
+            case INFLATE_HUFFMAN: {
+                int32_t sym = decode(&lenTable);
+                if(sym < 256) {
+                    if(sym < 0) {
+                        state = INFLATE_ERROR;
+                        break;
+                    }
+                    win[outPosition++ & mask] = (uint8_t)sym;
+                    dst[count++] = (uint8_t)sym;
+                }
+                else if(sym == 256)
+                    state = INFLATE_BLOCK_HEADER;
+                else {
+                    sym -= 257;
+                    if(sym >= 29) {
+                        state = INFLATE_ERROR;
+                        break;
+                    }
+                    uint32_t len = lengthBase[sym] + getBits(lengthExtra[sym]);
+                    int32_t dist = decode(&distTable);
+                    if(dist < 0 || dist >= 30) {
+                        state = INFLATE_ERROR;
+                        break;
+                    }
+                    uint32_t distance = distBase[dist] + getBits(distExtra[dist]);
+                    if(distance > outPosition || distance > (mask + 1)) {
+                        state = INFLATE_ERROR;
+                        break;
+                    }
+                    copyLength = len;
+                    copyDistance = distance;
+                }
+                break;
+            }
+            case INFLATE_DONE:
+                return count;
+            default:
+                return -1;
+        }
+        /* Bits taken from beyond the end of the entry mean the stream is truncated */
+        if((padding * 8) > bitCount) {
+            state = INFLATE_ERROR;
+            return -1;
+        }
+    }
+    return count;
+}
+
+int32_t Inflater::read(uint32_t offset, uint8_t *dst, uint32_t size) {
+    /* The stream can only be decoded forwards, going back means starting over */
+    if(offset < outPosition) reset();
+    while(outPosition < offset) {
+        uint8_t skip[64];
+        uint32_t len = offset - outPosition;
+        if(len > sizeof(skip)) len = sizeof(skip);
+        int32_t ret = inflate(skip, len);
+        if(ret <= 0) return ret;
+    }
+    return inflate(dst, size);
+}
@@ -5,14 +5,20 @@
 #include "flint_java_class.h"
 
 typedef struct {
-    FieldsData fields;
     const char *typeName;
     ClassLoader *classLoader;
+    JClass *elementType;        /* Innermost component class of an array class, NULL until it is looked up */
+    uint8_t dimensions;
 } InternalData;
 
-JClass::JClass(const char *typeName, ClassLoader *loader) : JObject(sizeof(FieldsData), NULL) {
+JClass::JClass(const char *typeName, ClassLoader *loader, uint32_t fieldsSize) : JObject(sizeof(InternalData) + fieldsSize, NULL) {
+    uint8_t dimensions = 0;
+    while(typeName[dimensions] == '[') dimensions++;
     ((InternalData *)data)->typeName = typeName;
     ((InternalData *)data)->classLoader = loader;
+    ((InternalData *)data)->elementType = NULL;
+    ((InternalData *)data)->dimensions = dimensions;
+    memset(&data[sizeof(InternalData)], 0, fieldsSize);
 }
 
 const char *JClass::getTypeName(void) const {
@@ -43,8 +49,19 @@ bool JClass::isPrimitive(void) const {
 }
 
 bool JClass::isArray(void) const {
-    const char *typeName = getTypeName();
-    return typeName[0] == '[';
+    return ((InternalData *)data)->dimensions > 0;
+}
+
+uint8_t JClass::getDimensions(void) const {
+    return ((InternalData *)data)->dimensions;
+}
+
+JClass *JClass::getElementType(void) const {
+    return ((InternalData *)data)->elementType;
+}
+
+void JClass::setElementType(JClass *type) {
+    ((InternalData *)data)->elementType = type;
 }
 
 JClass *JClass::getNestHost(FExec *ctx) {
@@ -79,6 +96,10 @@ uint8_t JClass::componentSize() const {
     }
 }
 
-uint32_t JClass::size(void) {
-    return sizeof(JClass) + sizeof(InternalData);
+uint32_t JClass::size(uint32_t fieldsSize) {
+    return sizeof(JClass) + sizeof(InternalData) + fieldsSize;
+}
+
+uint32_t JClass::fieldsOffset(void) {
+    return sizeof(InternalData);
 }
@@ -1,5 +1,4 @@
 
-#include <new>
 #include <string.h>
 #include "flint.h"
 #include "flint_java_class.h"
@@ -7,7 +6,7 @@
 
 JObject::JObject(uint32_t size, JClass *type) :
 ListNode(),
-size(size), prot(0x02), type(type), monitorCount(0), ownId(0) {
+size(size), prot(0x02), type(type), monitor() {
 
 }
 
@@ -17,13 +16,6 @@ const char *JObject::getTypeName(void) const {
     return type->getTypeName();
 }
 
-bool JObject::initFields(Flint *flint, FExec *ctx, ClassLoader *loader) {
-    FieldsData *field = (FieldsData *)data;
-    new (field)FieldsData();
-
-    return field->init(flint, ctx, loader, false);
-}
-
 static void throwNoSuchFieldError(FExec *ctx, const char *clsName, const char *name) {
     Flint *flint = ctx->getFlint();
     JClass *excpCls = flint->findClass(ctx, "java/lang/NoSuchFieldError");
@@ -31,21 +23,28 @@ static void throwNoSuchFieldError(FExec *ctx, const char *clsName, const char *n
 }
 
 FieldValue *JObject::getField(FExec *ctx, ConstField *field) const {
-    FieldValue *ret = ((FieldsData *)data)->getField(field);
-    if(ret == NULL && ctx != NULL)
-        throwNoSuchFieldError(ctx, field->className, field->nameAndType->name);
-    return ret;
-}
-
-FieldValue *JObject::getField(FExec *ctx, const char *name) const {
-    FieldValue *ret = ((FieldsData *)data)->getField(name);
-    if(ret == NULL && ctx != NULL)
-        throwNoSuchFieldError(ctx, getTypeName(), name);
-    return ret;
+    if(field->fieldIndex == 0) {
+        ClassLoader *loader = field->loader;
+        if(loader == NULL) {
+            loader = ctx->getFlint()->findLoader(ctx, field->className);
+            if(loader == NULL) return NULL;
+            field->loader = loader;
+        }
+        if(!loader->initLayout(ctx)) return NULL;
+        FieldInfo *fieldInfo = loader->getInstanceField(field->nameAndType);
+        if(fieldInfo == NULL) {
+            throwNoSuchFieldError(ctx, field->className, field->nameAndType->name);
+            return NULL;
+        }
+        field->fieldIndex = fieldInfo->getSlot() | 0x80000000;
+    }
+    return getFieldByIndex(field->fieldIndex & 0x7FFFFFFF);
 }
 
 FieldValue *JObject::getFieldByIndex(uint32_t index) const {
-    return ((FieldsData *)data)->getFieldByIndex(index);
+    /* Instance fields are stored inline, after the internal data in the case of JClass */
+    FieldValue *fields = (FieldValue *)((type != NULL) ? data : &data[JClass::fieldsOffset()]);
+    return &fields[index];
 }
 
 void JObject::clearData(void) {
@@ -84,8 +83,3 @@ void JObject::setProtected(void) {
 uint8_t JObject::getProtected(void) const {
     return prot;
 }
-
-void JObject::destroy(Flint *flint) {
-    if(type == NULL || type->isArray() == false)
-        ((FieldsData *)data)->destroy(flint);
-}
@@ -3,6 +3,7 @@
 #include "flint_common.h"
 #include "flint_native.h"
 #include "flint_method_info.h"
+#include "flint_stack_map.h"
 
 ExceptionTable::ExceptionTable(uint16_t startPc, uint16_t endPc, uint16_t handlerPc, uint16_t catchType) :
 startPc(startPc), endPc(endPc), handlerPc(handlerPc), catchType(catchType) {
@@ -10,7 +11,7 @@ startPc(startPc), endPc(endPc), handlerPc(handlerPc), catchType(catchType) {
 }
 
 MethodInfo::MethodInfo(ClassLoader *loader, MethodAccessFlag accessFlag, const char *name, const char *desc) :
-accessFlag(accessFlag), loader(loader), name(name), desc(desc),
+accessFlag(accessFlag), tableIndex(NON_VIRTUAL_INDEX), loader(loader), name(name), desc(desc),
 hash((Hash(name) & 0xFFFF) | (Hash(desc) << 16)), retType(NULL), code(NULL) {
 
 }
@@ -57,3 +58,12 @@ ExceptionTable *MethodInfo::getException(uint16_t index) const {
     CodeAttribute *codeAttr = (CodeAttribute *)code;
     return &((ExceptionTable *)codeAttr->data)[index];
 }
+
+InlineCache *MethodInfo::getInlineCache(uint16_t index) const {
+    return &((CodeAttribute *)code)->inlineCaches[index];
+}
+
+const StackMap *MethodInfo::getStackMap(void) const {
+    if(accessFlag & (METHOD_NATIVE | METHOD_ABSTRACT | METHOD_UNLOADED)) return NULL;
+    return ((CodeAttribute *)code)->stackMap;
+}
@@ -0,0 +1,41 @@
+
+#include "flint_monitor.h"
+#include "flint_execution.h"
+
+Monitor::Monitor(FExec *owner) : owner(owner), entryQueue(NULL), waitSet(NULL) {
+
+}
+
+void Monitor::enqueue(FExec **queue, FExec *exec) {
+    exec->monitorNext = NULL;
+    while(*queue != NULL)
+        queue = &(*queue)->monitorNext;
+    *queue = exec;
+}
+
+bool Monitor::remove(FExec **queue, FExec *exec) {
+    for(; *queue != NULL; queue = &(*queue)->monitorNext) {
+        if(*queue == exec) {
+            *queue = exec->monitorNext;
+            exec->monitorNext = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+LockWord::LockWord(void) : word(0), count(0) {
+
+}
+
+FExec *LockWord::getOwner(void) const {
+    uint32_t value = word.load(std::memory_order_acquire);
+    if(value & 0x01)
+        return ((Monitor *)(value & ~0x01))->owner;
+    return (FExec *)value;
+}
+
+Monitor *LockWord::getMonitor(void) const {
+    uint32_t value = word.load(std::memory_order_acquire);
+    return (value & 0x01) ? (Monitor *)(value & ~0x01) : NULL;
+}
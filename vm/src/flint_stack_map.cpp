@@ -0,0 +1,711 @@
+
+#include <string.h>
+#include "flint.h"
+#include "flint_common.h"
+#include "flint_opcodes.h"
+#include "flint_class_loader.h"
+#include "flint_stack_map.h"
+
+#define BIT_GET(_bits, _index)      (((_bits)[(_index) / 32] >> ((_index) % 32)) & 0x01)
+#define BIT_SET(_bits, _index)      ((_bits)[(_index) / 32] |= (1U << ((_index) % 32)))
+#define BIT_CLR(_bits, _index)      ((_bits)[(_index) / 32] &= ~(1U << ((_index) % 32)))
+
+#define BLOCK_VISITED               0x01
+#define BLOCK_DIRTY                 0x02
+
+static bool isSite(uint8_t opcode) {
+    switch(opcode) {
+        case OP_GETSTATIC:
+        case OP_PUTSTATIC:
+        case OP_INVOKEVIRTUAL ... OP_INVOKEINTERFACE:
+        case OP_INVOKEVIRTUAL_IC:
+        case OP_INVOKEINTERFACE_IC:
+        case OP_NEW:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint8_t getTypeSlots(const char *type) {
+    switch(type[0]) {
+        case 'V': return 0;
+        case 'J':
+        case 'D': return 2;
+        default: return 1;
+    }
+}
+
+static int32_t readInt16(const uint8_t *p) {
+    return (int16_t)((p[0] << 8) | p[1]);
+}
+
+static int32_t readInt32(const uint8_t *p) {
+    return (int32_t)((p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+}
+
+/*
+ * Abstract interpretation over the bytecode with one bit of type per slot. The state is kept only at the start of
+ * each basic block and joined with AND, so a slot that holds a reference on one path and something else on another
+ * is not a reference. Gives up (no map) on jsr/ret and on anything that does not look like verified code
+ */
+class StackMap::Builder {
+public:
+    ClassLoader *loader;
+    CodeAttribute *codeAttr;
+    const uint8_t *code;
+    uint32_t codeLength;
+    uint16_t maxLocals;
+    uint16_t slotCount;
+    uint16_t wordCount;
+    uint16_t siteCount;
+    uint32_t blockCount;
+    uint32_t *boundaries;           /* One bit per pc, set at the start of each instruction */
+    uint32_t *blockStarts;          /* One bit per pc, set at the start of each basic block */
+    uint32_t *blockPcs;
+    uint32_t *states;               /* wordCount words per block */
+    uint16_t *depths;
+    uint8_t *flags;
+    uint32_t *cur;
+    uint16_t depth;
+
+    bool scan(void) {
+        uint32_t bitWords = codeLength / 32 + 1;
+        memset(boundaries, 0, bitWords * sizeof(uint32_t));
+        memset(blockStarts, 0, bitWords * sizeof(uint32_t));
+        BIT_SET(blockStarts, 0);
+        siteCount = 0;
+        uint32_t len;
+        for(uint32_t pc = 0; pc < codeLength; pc += len) {
+            len = GetInstructionLength(code, pc);
+            if(pc + len > codeLength) return false;
+            BIT_SET(boundaries, pc);
+            if(isSite(code[pc])) siteCount++;
+            switch(code[pc]) {
+                case OP_IFEQ ... OP_GOTO:
+                case OP_IFNULL_PTR:
+                case OP_IFNONNULL_PTR:
+                    if(!markBlock(pc + readInt16(&code[pc + 1]))) return false;
+                    break;
+                case OP_GOTO_W:
+                    if(!markBlock(pc + readInt32(&code[pc + 1]))) return false;
+                    break;
+                case OP_TABLESWITCH: {
+                    const uint8_t *p = &code[(pc + 4) & ~0x03];
+                    int32_t count = readInt32(&p[8]) - readInt32(&p[4]) + 1;
+                    if(!markBlock(pc + readInt32(&p[0]))) return false;
+                    for(int32_t i = 0; i < count; i++)
+                        if(!markBlock(pc + readInt32(&p[12 + i * 4]))) return false;
+                    break;
+                }
+                case OP_LOOKUPSWITCH: {
+                    const uint8_t *p = &code[(pc + 4) & ~0x03];
+                    int32_t count = readInt32(&p[4]);
+                    if(!markBlock(pc + readInt32(&p[0]))) return false;
+                    for(int32_t i = 0; i < count; i++)
+                        if(!markBlock(pc + readInt32(&p[12 + i * 8]))) return false;
+                    break;
+                }
+                case OP_IRETURN ... OP_RETURN:
+                case OP_ATHROW:
+                    break;
+                case OP_JSR:
+                case OP_RET:
+                case OP_JSRW:
+                    return false;
+                case OP_WIDE:
+                    if(code[pc + 1] == OP_RET) return false;
+                    continue;
+                default:
+                    continue;
+            }
+            /* The instruction after a branch starts a new block */
+            if(pc + len < codeLength) BIT_SET(blockStarts, pc + len);
+        }
+        ExceptionTable *excps = (ExceptionTable *)codeAttr->data;
+        for(uint16_t i = 0; i < codeAttr->exceptionLength; i++) {
+            if(excps[i].startPc >= excps[i].endPc || excps[i].endPc > codeLength) return false;
+            if(!markBlock(excps[i].handlerPc)) return false;
+        }
+        blockCount = 0;
+        for(uint32_t pc = 0; pc < codeLength; pc++) {
+            if(!BIT_GET(blockStarts, pc)) continue;
+            if(!BIT_GET(boundaries, pc)) return false;
+            blockCount++;
+        }
+        return true;
+    }
+
+    bool markBlock(int64_t pc) {
+        if(pc < 0 || pc >= codeLength) return false;
+        BIT_SET(blockStarts, pc);
+        return true;
+    }
+
+    int32_t findBlock(uint32_t pc) const {
+        uint32_t low = 0, high = blockCount;
+        while(low < high) {
+            uint32_t mid = (low + high) / 2;
+            if(blockPcs[mid] == pc) return mid;
+            if(blockPcs[mid] < pc) low = mid + 1;
+            else high = mid;
+        }
+        return -1;
+    }
+
+    bool merge(uint32_t pc, const uint32_t *state, uint16_t stateDepth) {
+        int32_t block = findBlock(pc);
+        if(block < 0) return false;
+        uint32_t *dst = &states[block * wordCount];
+        if(!(flags[block] & BLOCK_VISITED)) {
+            memcpy(dst, state, wordCount * sizeof(uint32_t));
+            depths[block] = stateDepth;
+            flags[block] = BLOCK_VISITED | BLOCK_DIRTY;
+            return true;
+        }
+        if(depths[block] != stateDepth) return false;
+        for(uint16_t i = 0; i < wordCount; i++) {
+            uint32_t value = dst[i] & state[i];
+            if(value != dst[i]) {
+                dst[i] = value;
+                flags[block] |= BLOCK_DIRTY;
+            }
+        }
+        return true;
+    }
+
+    bool mergeHandlers(uint32_t pc) {
+        ExceptionTable *excps = (ExceptionTable *)codeAttr->data;
+        bool ret = true;
+        for(uint16_t i = 0; i < codeAttr->exceptionLength && ret; i++) {
+            if(pc < excps[i].startPc || pc >= excps[i].endPc) continue;
+            /* The handler is entered with the locals of the throwing instruction and the exception alone on the stack */
+            uint32_t saved = BIT_GET(cur, maxLocals);
+            BIT_SET(cur, maxLocals);
+            ret = merge(excps[i].handlerPc, cur, 1);
+            if(!saved) BIT_CLR(cur, maxLocals);
+        }
+        return ret;
+    }
+
+    bool push(bool isRef) {
+        if(maxLocals + depth >= slotCount) return false;
+        if(isRef) BIT_SET(cur, maxLocals + depth);
+        else BIT_CLR(cur, maxLocals + depth);
+        depth++;
+        return true;
+    }
+
+    bool pop(uint16_t count) {
+        if(depth < count) return false;
+        depth -= count;
+        return true;
+    }
+
+    bool peek(uint16_t index) const {
+        return BIT_GET(cur, maxLocals + depth - 1 - index);
+    }
+
+    bool pushType(const char *type) {
+        switch(type[0]) {
+            case 'V': return true;
+            case 'J':
+            case 'D': return push(false) && push(false);
+            case 'L':
+            case '[': return push(true);
+            default: return push(false);
+        }
+    }
+
+    bool load(uint32_t index, uint8_t count, bool isRef) {
+        if(index + count > maxLocals) return false;
+        if(isRef) return push(BIT_GET(cur, index));
+        while(count--) if(!push(false)) return false;
+        return true;
+    }
+
+    bool store(uint32_t index, uint8_t count, bool isRef) {
+        if(index + count > maxLocals || depth < count) return false;
+        if(isRef) {
+            if(peek(0)) BIT_SET(cur, index);
+            else BIT_CLR(cur, index);
+        }
+        else for(uint8_t i = 0; i < count; i++) BIT_CLR(cur, index + i);
+        return pop(count);
+    }
+
+    bool dup(uint8_t popCount, const uint8_t *order, uint8_t orderLength) {
+        /* order lists the slots to push from the bottom up, 0 is the top of the stack before the instruction */
+        bool values[4];
+        if(depth < popCount) return false;
+        for(uint8_t i = 0; i < popCount; i++) values[i] = peek(i);
+        depth -= popCount;
+        for(uint8_t i = 0; i < orderLength; i++)
+            if(!push(values[order[i]])) return false;
+        return true;
+    }
+
+    bool invoke(uint16_t poolIndex, bool hasReceiver) {
+        const char *desc = loader->getConstMemberDesc(poolIndex);
+        if(desc == NULL || desc[0] != '(') return false;
+        if(!pop(GetArgSlotCount(desc) + (hasReceiver ? 1 : 0))) return false;
+        return pushType(strchr(desc, ')') + 1);
+    }
+
+    /* Runs a block from its entry state, recording the sites into map if it is not NULL */
+    bool run(uint32_t block, StackMap *map) {
+        uint32_t pc = blockPcs[block];
+        memcpy(cur, &states[block * wordCount], wordCount * sizeof(uint32_t));
+        depth = depths[block];
+        while(true) {
+            if(!mergeHandlers(pc)) return false;
+            uint8_t opcode = code[pc];
+            if(map != NULL && isSite(opcode)) {
+                uint32_t *record = &map->records[map->siteCount * (wordCount + 1)];
+                record[0] = pc | ((uint32_t)(maxLocals + depth) << 16);
+                memcpy(&record[1], cur, wordCount * sizeof(uint32_t));
+                map->siteCount++;
+            }
+            uint32_t len = GetInstructionLength(code, pc);
+            bool ok = true;
+            bool isEnd = false;
+            switch(opcode) {
+                case OP_NOP:
+                case OP_IINC:
+                    break;
+                case OP_ACONST_NULL_PTR:
+                    ok = push(true);
+                    break;
+                case OP_ICONST_M1 ... OP_ICONST_5:
+                case OP_FCONST_0 ... OP_FCONST_2:
+                case OP_BIPUSH:
+                case OP_SIPUSH:
+                    ok = push(false);
+                    break;
+                case OP_LCONST_0:
+                case OP_LCONST_1:
+                case OP_DCONST_0:
+                case OP_DCONST_1:
+                case OP_LDC2_W:
+                    ok = push(false) && push(false);
+                    break;
+                case OP_LDC:
+                case OP_LDC_W: {
+                    uint16_t poolIndex = (opcode == OP_LDC) ? code[pc + 1] : (uint16_t)readInt16(&code[pc + 1]);
+                    ConstPoolTag tag = loader->getConstPoolTag(poolIndex);
+                    ok = push(tag == CONST_STRING || tag == CONST_CLASS || tag == CONST_METHOD_TYPE || tag == CONST_METHOD_HANDLE);
+                    break;
+                }
+                case OP_ILOAD:
+                case OP_FLOAD:
+                    ok = load(code[pc + 1], 1, false);
+                    break;
+                case OP_LLOAD:
+                case OP_DLOAD:
+                    ok = load(code[pc + 1], 2, false);
+                    break;
+                case OP_ALOAD:
+                    ok = load(code[pc + 1], 1, true);
+                    break;
+                case OP_ILOAD_0 ... OP_ILOAD_3:
+                    ok = load(opcode - OP_ILOAD_0, 1, false);
+                    break;
+                case OP_FLOAD_0 ... OP_FLOAD_3:
+                    ok = load(opcode - OP_FLOAD_0, 1, false);
+                    break;
+                case OP_LLOAD_0 ... OP_LLOAD_3:
+                    ok = load(opcode - OP_LLOAD_0, 2, false);
+                    break;
+                case OP_DLOAD_0 ... OP_DLOAD_3:
+                    ok = load(opcode - OP_DLOAD_0, 2, false);
+                    break;
+                case OP_ALOAD_0 ... OP_ALOAD_3:
+                    ok = load(opcode - OP_ALOAD_0, 1, true);
+                    break;
+                case OP_IALOAD:
+                case OP_FALOAD:
+                case OP_BALOAD:
+                case OP_CALOAD:
+                case OP_SALOAD:
+                    ok = pop(2) && push(false);
+                    break;
+                case OP_LALOAD:
+                case OP_DALOAD:
+                    ok = pop(2) && push(false) && push(false);
+                    break;
+                case OP_AALOAD:
+                    ok = pop(2) && push(true);
+                    break;
+                case OP_ISTORE:
+                case OP_FSTORE:
+                    ok = store(code[pc + 1], 1, false);
+                    break;
+                case OP_LSTORE:
+                case OP_DSTORE:
+                    ok = store(code[pc + 1], 2, false);
+                    break;
+                case OP_ASTORE:
+                    ok = store(code[pc + 1], 1, true);
+                    break;
+                case OP_ISTORE_0 ... OP_ISTORE_3:
+                    ok = store(opcode - OP_ISTORE_0, 1, false);
+                    break;
+                case OP_FSTORE_0 ... OP_FSTORE_3:
+                    ok = store(opcode - OP_FSTORE_0, 1, false);
+                    break;
+                case OP_LSTORE_0 ... OP_LSTORE_3:
+                    ok = store(opcode - OP_LSTORE_0, 2, false);
+                    break;
+                case OP_DSTORE_0 ... OP_DSTORE_3:
+                    ok = store(opcode - OP_DSTORE_0, 2, false);
+                    break;
+                case OP_ASTORE_0 ... OP_ASTORE_3:
+                    ok = store(opcode - OP_ASTORE_0, 1, true);
+                    break;
+                case OP_IASTORE:
+                case OP_FASTORE:
+                case OP_AASTORE:
+                case OP_BASTORE:
+                case OP_CASTORE:
+                case OP_SASTORE:
+                    ok = pop(3);
+                    break;
+                case OP_LASTORE:
+                case OP_DASTORE:
+                    ok = pop(4);
+                    break;
+                case OP_POP:
+                case OP_MONITORENTER:
+                case OP_MONITOREXIT:
+                    ok = pop(1);
+                    break;
+                case OP_POP2:
+                    ok = pop(2);
+                    break;
+                case OP_DUP: {
+                    static const uint8_t order[] = {0, 0};
+                    ok = dup(1, order, sizeof(order));
+                    break;
+                }
+                case OP_DUP_X1: {
+                    static const uint8_t order[] = {0, 1, 0};
+                    ok = dup(2, order, sizeof(order));
+                    break;
+                }
+                case OP_DUP_X2: {
+                    static const uint8_t order[] = {0, 2, 1, 0};
+                    ok = dup(3, order, sizeof(order));
+                    break;
+                }
+                case OP_DUP2: {
+                    static const uint8_t order[] = {1, 0, 1, 0};
+                    ok = dup(2, order, sizeof(order));
+                    break;
+                }
+                case OP_DUP2_X1: {
+                    static const uint8_t order[] = {1, 0, 2, 1, 0};
+                    ok = dup(3, order, sizeof(order));
+                    break;
+                }
+                case OP_DUP2_X2: {
+                    static const uint8_t order[] = {1, 0, 3, 2, 1, 0};
+                    ok = dup(4, order, sizeof(order));
+                    break;
+                }
+                case OP_SWAP: {
+                    static const uint8_t order[] = {0, 1};
+                    ok = dup(2, order, sizeof(order));
+                    break;
+                }
+                case OP_IADD:
+                case OP_FADD:
+                case OP_ISUB:
+                case OP_FSUB:
+                case OP_IMUL:
+                case OP_FMUL:
+                case OP_IDIV:
+                case OP_FDIV:
+                case OP_IREM:
+                case OP_FREM:
+                case OP_ISHL:
+                case OP_ISHR:
+                case OP_IUSHR:
+                case OP_IAND:
+                case OP_IOR:
+                case OP_IXOR:
+                case OP_FCMPL:
+                case OP_FCMPG:
+                    ok = pop(2) && push(false);
+                    break;
+                case OP_LADD:
+                case OP_DADD:
+                case OP_LSUB:
+                case OP_DSUB:
+                case OP_LMUL:
+                case OP_DMUL:
+                case OP_LDIV:
+                case OP_DDIV:
+                case OP_LREM:
+                case OP_DREM:
+                case OP_LAND:
+                case OP_LOR:
+                case OP_LXOR:
+                    ok = pop(4) && push(false) && push(false);
+                    break;
+                case OP_LSHL:
+                case OP_LSHR:
+                case OP_LUSHR:
+                    ok = pop(3) && push(false) && push(false);
+                    break;
+                case OP_INEG:
+                case OP_FNEG:
+                case OP_I2F:
+                case OP_F2I:
+                case OP_I2B:
+                case OP_I2C:
+                case OP_I2S:
+                case OP_ARRAYLENGTH:
+                case OP_INSTANCEOF:
+                    ok = pop(1) && push(false);
+                    break;
+                case OP_LNEG:
+                case OP_DNEG:
+                case OP_L2D:
+                case OP_D2L:
+                    ok = pop(2) && push(false) && push(false);
+                    break;
+                case OP_I2L:
+                case OP_I2D:
+                case OP_F2L:
+                case OP_F2D:
+                    ok = pop(1) && push(false) && push(false);
+                    break;
+                case OP_L2I:
+                case OP_L2F:
+                case OP_D2I:
+                case OP_D2F:
+                    ok = pop(2) && push(false);
+                    break;
+                case OP_LCMP:
+                case OP_DCMPL:
+                case OP_DCMPG:
+                    ok = pop(4) && push(false);
+                    break;
+                case OP_IFEQ ... OP_IFLE:
+                case OP_IFNULL_PTR:
+                case OP_IFNONNULL_PTR:
+                    ok = pop(1) && merge(pc + readInt16(&code[pc + 1]), cur, depth);
+                    break;
+                case OP_IF_ICMPEQ ... OP_IF_ACMPNE:
+                    ok = pop(2) && merge(pc + readInt16(&code[pc + 1]), cur, depth);
+                    break;
+                case OP_GOTO:
+                    ok = merge(pc + readInt16(&code[pc + 1]), cur, depth);
+                    isEnd = true;
+                    break;
+                case OP_GOTO_W:
+                    ok = merge(pc + readInt32(&code[pc + 1]), cur, depth);
+                    isEnd = true;
+                    break;
+                case OP_TABLESWITCH: {
+                    const uint8_t *p = &code[(pc + 4) & ~0x03];
+                    int32_t count = readInt32(&p[8]) - readInt32(&p[4]) + 1;
+                    ok = pop(1) && merge(pc + readInt32(&p[0]), cur, depth);
+                    for(int32_t i = 0; i < count && ok; i++)
+                        ok = merge(pc + readInt32(&p[12 + i * 4]), cur, depth);
+                    isEnd = true;
+                    break;
+                }
+                case OP_LOOKUPSWITCH: {
+                    const uint8_t *p = &code[(pc + 4) & ~0x03];
+                    int32_t count = readInt32(&p[4]);
+                    ok = pop(1) && merge(pc + readInt32(&p[0]), cur, depth);
+                    for(int32_t i = 0; i < count && ok; i++)
+                        ok = merge(pc + readInt32(&p[12 + i * 8]), cur, depth);
+                    isEnd = true;
+                    break;
+                }
+                case OP_IRETURN ... OP_RETURN:
+                case OP_ATHROW:
+                    isEnd = true;
+                    break;
+                case OP_GETSTATIC:
+                case OP_PUTSTATIC:
+                case OP_GETFIELD:
+                case OP_PUTFIELD: {
+                    const char *desc = loader->getConstMemberDesc((uint16_t)readInt16(&code[pc + 1]));
+                    if(desc == NULL) return false;
+                    if(opcode == OP_GETSTATIC) ok = pushType(desc);
+                    else if(opcode == OP_PUTSTATIC) ok = pop(getTypeSlots(desc));
+                    else if(opcode == OP_GETFIELD) ok = pop(1) && pushType(desc);
+                    else ok = pop(getTypeSlots(desc) + 1);
+                    break;
+                }
+                case OP_INVOKESPECIAL:
+                    ok = invoke((uint16_t)readInt16(&code[pc + 1]), true);
+                    break;
+                case OP_INVOKESTATIC:
+                case OP_INVOKEDYNAMIC:
+                    ok = invoke((uint16_t)readInt16(&code[pc + 1]), false);
+                    break;
+                case OP_INVOKEVIRTUAL:
+                case OP_INVOKEINTERFACE:
+                    ok = invoke((uint16_t)readInt16(&code[pc + 1]), true);
+                    break;
+                case OP_INVOKEVIRTUAL_IC:
+                case OP_INVOKEINTERFACE_IC:
+                    ok = invoke(codeAttr->inlineCaches[(uint16_t)readInt16(&code[pc + 1])].poolIndex, true);
+                    break;
+                case OP_NEW:
+                    ok = push(true);
+                    break;
+                case OP_NEWARRAY:
+                case OP_ANEWARRAY:
+                case OP_CHECKCAST:
+                    ok = pop(1) && push(true);
+                    break;
+                case OP_MULTIANEWARRAY:
+                    ok = pop(code[pc + 3]) && push(true);
+                    break;
+                case OP_WIDE: {
+                    uint16_t index = (uint16_t)readInt16(&code[pc + 2]);
+                    switch(code[pc + 1]) {
+                        case OP_ILOAD:
+                        case OP_FLOAD: ok = load(index, 1, false); break;
+                        case OP_LLOAD:
+                        case OP_DLOAD: ok = load(index, 2, false); break;
+                        case OP_ALOAD: ok = load(index, 1, true); break;
+                        case OP_ISTORE:
+                        case OP_FSTORE: ok = store(index, 1, false); break;
+                        case OP_LSTORE:
+                        case OP_DSTORE: ok = store(index, 2, false); break;
+                        case OP_ASTORE: ok = store(index, 1, true); break;
+                        case OP_IINC: break;
+                        default: return false;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+            if(!ok) return false;
+            if(isEnd) return true;
+            pc += len;
+            if(pc >= codeLength) return false;
+            if(BIT_GET(blockStarts, pc)) return merge(pc, cur, depth);
+        }
+    }
+
+    bool initEntryState(MethodInfo *method) {
+        uint32_t *entry = &states[0];
+        memset(entry, 0, wordCount * sizeof(uint32_t));
+        uint32_t index = 0;
+        if(!(method->accessFlag & METHOD_STATIC)) {
+            BIT_SET(entry, 0);
+            index++;
+        }
+        for(const char *arg = GetNextArgName(method->desc); arg != NULL; arg = GetNextArgName(arg)) {
+            if(arg[0] == 'L' || arg[0] == '[') BIT_SET(entry, index);
+            index += getTypeSlots(arg);
+        }
+        if(index > maxLocals) return false;
+        depths[0] = 0;
+        flags[0] = BLOCK_VISITED | BLOCK_DIRTY;
+        return true;
+    }
+
+    bool solve(void) {
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            for(uint32_t i = 0; i < blockCount; i++) {
+                if(!(flags[i] & BLOCK_DIRTY)) continue;
+                flags[i] &= ~BLOCK_DIRTY;
+                if(!run(i, NULL)) return false;
+                changed = true;
+            }
+        }
+        return true;
+    }
+};
+
+const uint32_t *StackMap::find(uint32_t pc, uint16_t *slotCount) const {
+    uint32_t stride = wordCount + 1;
+    uint32_t low = 0, high = siteCount;
+    while(low < high) {
+        uint32_t mid = (low + high) / 2;
+        const uint32_t *record = &records[mid * stride];
+        uint32_t sitePc = record[0] & 0xFFFF;
+        if(sitePc == pc) {
+            *slotCount = (uint16_t)(record[0] >> 16);
+            return &record[1];
+        }
+        if(sitePc < pc) low = mid + 1;
+        else high = mid;
+    }
+    return NULL;
+}
+
+StackMap *StackMap::build(Flint *flint, ClassLoader *loader, MethodInfo *method, CodeAttribute *codeAttr) {
+    uint32_t slotCount = codeAttr->maxLocals + codeAttr->maxStack;
+    if(codeAttr->codeLength > 0xFFFF || slotCount > 0xFFFF) return NULL;
+
+    Builder builder;
+    builder.loader = loader;
+    builder.codeAttr = codeAttr;
+    builder.code = (uint8_t *)&((ExceptionTable *)codeAttr->data)[codeAttr->exceptionLength];
+    builder.codeLength = codeAttr->codeLength;
+    builder.maxLocals = codeAttr->maxLocals;
+    builder.slotCount = slotCount;
+    builder.wordCount = slotCount / 32 + 1;
+
+    /* The maps are optional, failing to allocate them only leaves the method to the conservative scan */
+    uint32_t bitWords = builder.codeLength / 32 + 1;
+    uint32_t *bits = (uint32_t *)flint->malloc(NULL, bitWords * 2 * sizeof(uint32_t));
+    if(bits == NULL) return NULL;
+    builder.boundaries = bits;
+    builder.blockStarts = &bits[bitWords];
+    if(!builder.scan() || builder.siteCount == 0) {
+        flint->free(bits);
+        return NULL;
+    }
+
+    uint32_t wordCount = builder.wordCount;
+    uint32_t blockCount = builder.blockCount;
+    uint32_t workSize = (blockCount * (wordCount + 1) + wordCount) * sizeof(uint32_t) + blockCount * (sizeof(uint16_t) + sizeof(uint8_t));
+    uint32_t *work = (uint32_t *)flint->malloc(NULL, workSize);
+    if(work == NULL) {
+        flint->free(bits);
+        return NULL;
+    }
+    builder.blockPcs = work;
+    builder.states = &work[blockCount];
+    builder.cur = &builder.states[blockCount * wordCount];
+    builder.depths = (uint16_t *)&builder.cur[wordCount];
+    builder.flags = (uint8_t *)&builder.depths[blockCount];
+    memset(builder.flags, 0, blockCount);
+    for(uint32_t pc = 0, i = 0; pc < builder.codeLength; pc++)
+        if(BIT_GET(builder.blockStarts, pc)) builder.blockPcs[i++] = pc;
+
+    StackMap *map = NULL;
+    if(builder.initEntryState(method) && builder.solve()) {
+        uint32_t mapSize = sizeof(StackMap) + builder.siteCount * (wordCount + 1) * sizeof(uint32_t);
+        map = (StackMap *)flint->malloc(NULL, mapSize);
+        if(map != NULL) {
+            map->siteCount = 0;
+            map->wordCount = wordCount;
+            /* Blocks are run in pc order, so the sites are recorded sorted. Sites in dead code get no record */
+            for(uint32_t i = 0; i < blockCount; i++) {
+                if(!(builder.flags[i] & BLOCK_VISITED)) continue;
+                if(!builder.run(i, map)) {
+                    flint->free(map);
+                    map = NULL;
+                    break;
+                }
+            }
+        }
+    }
+    flint->free(work);
+    flint->free(bits);
+    return map;
+}
@@ -1,130 +1,108 @@
 
 #include <string.h>
 #include "flint.h"
+#include "flint_common.h"
 #include "flint_zip_file_reader.h"
 
-ZipFileReader::ZipFileReader(void) : FileReader() {
+ZipFileReader::ZipFileReader(void) : FileReader(), entry(NULL), inflater(NULL), dataOffset(0) {
 
 }
 
-ZipFileReader::ZipFileReader(FExec *ctx, const char *filePath) : FileReader(ctx, filePath) {
+ZipFileReader::ZipFileReader(Flint *flint, FExec *ctx, const char *filePath) : FileReader(flint, ctx, filePath), entry(NULL), inflater(NULL), dataOffset(0) {
 
 }
 
-bool ZipFileReader::gotoEOCD(void) {
-    return seek(size() - 22);
-}
-
-int32_t ZipFileReader::gotoCDFH(void) {
-    if(!gotoEOCD()) return -1;
-    uint16_t fileCount;
-    uint32_t magicNum, CDFHPos;
-    uint32_t pos = tell();
-
-    if(!readUInt32(magicNum)) return -1;
-    if(!seek(pos + 10)) return -1;
-    if(!readUInt16(fileCount)) return -1;
-    if(!seek(pos + 16)) return -1;
-    if(!readUInt32(CDFHPos)) return -1;
-    if(!seek(CDFHPos)) return -1;
-
-    return fileCount;
-}
-
-bool ZipFileReader::gotoFile(const char *name, uint16_t length) {
+bool ZipFileReader::gotoEntry(const char *name, uint16_t length, const char *ext) {
     if(length == 0xFFFF) length = strlen(name);
+    uint16_t extLength = (ext != NULL) ? strlen(ext) : 0;
 
-    int32_t fileCount = gotoCDFH();
-    if(fileCount < 0) return false;
+    freeInflater();
+    entry = NULL;
 
-    for(uint32_t i = 0; i < fileCount; i++) {
-        uint32_t off = tell();
+    ZipIndex *index = flint->getZipIndex(this);
+    if(index == NULL) return false;
 
-        if(!seek(off + 28)) return false;
+    uint32_t nameHash = Hash(name, length);
+    if(ext != NULL) nameHash = Hash(ext, extLength, nameHash);
 
-        uint16_t nameLen, fieldLen, cmtLen;
+    /* The index only holds name hashes, the name is verified against the local file header */
+    for(const ZipEntry *e = index->findEntry(nameHash); e != NULL; e = index->nextEntry(e)) {
+        if(!seek(e->offset + 26)) return false;
+
+        uint16_t nameLen, fieldLen;
         if(!readUInt16(nameLen)) return false;
         if(!readUInt16(fieldLen)) return false;
-        if(!readUInt16(cmtLen)) return false;
-
-        uint32_t fileOff;
-        if(!seek(off + 42)) return false;
-        if(!readUInt32(fileOff)) return false;
-
-        if(nameLen == length) {
-            bool isOk = true;
-            char buff[16];
-            uint32_t N = length / sizeof(buff);
-            for(uint32_t i = 0; isOk && (i < N); i++) {
-                if(read(buff, sizeof(buff)) != sizeof(buff)) return false;
-                if(strncmp(&name[i * sizeof(buff)], buff, sizeof(buff)) != 0)
-                    isOk = false;
-            }
-            N = length % sizeof(buff);
-            if(isOk && N > 0) {
-                if(read(buff, N) != N) return false;
-                isOk = strncmp(&name[length - N], buff, N) == 0;
-            }
-            if(isOk) {
-                if(!seek(fileOff + 26)) return false;
-                if(!readUInt16(nameLen)) return false;
-                if(!readUInt16(fieldLen)) return false;
-                if(!seek(fileOff + 30 + nameLen + fieldLen)) return false;
-                return true;
+        if(nameLen != (length + extLength)) continue;
+
+        bool isOk = true;
+        char buff[16];
+        uint32_t N = length / sizeof(buff);
+        for(uint32_t i = 0; isOk && (i < N); i++) {
+            if(read(buff, sizeof(buff)) != sizeof(buff)) return false;
+            if(strncmp(&name[i * sizeof(buff)], buff, sizeof(buff)) != 0)
+                isOk = false;
+        }
+        N = length % sizeof(buff);
+        if(isOk && N > 0) {
+            if(read(buff, N) != N) return false;
+            isOk = strncmp(&name[length - N], buff, N) == 0;
+        }
+        if(isOk && extLength > 0) {
+            if(read(buff, extLength) != extLength) return false;
+            isOk = strncmp(ext, buff, extLength) == 0;
+        }
+        if(isOk) {
+            if(!offset(fieldLen)) return false;
+            if(e->method == ZIP_METHOD_DEFLATED) {
+                /* From here on positions are offsets into the inflated data, based at the start of the entry data */
+                dataOffset = tell();
+                inflater = Inflater::create(flint, ctx, handle, dataOffset, e->compressedSize, e->size);
+                if(inflater == NULL) return false;
+                discardBuffer();
             }
+            else if(e->method != ZIP_METHOD_STORED)
+                return false;
+            entry = e;
+            return true;
         }
-        if(!seek(off + 46 + nameLen + fieldLen + cmtLen)) return false;
     }
     return false;
 }
 
+bool ZipFileReader::gotoFile(const char *name, uint16_t length) {
+    return gotoEntry(name, length, NULL);
+}
+
 bool ZipFileReader::gotoClassFile(const char *name, uint16_t length) {
-    if(length == 0xFFFF) length = strlen(name);
+    return gotoEntry(name, length, ".class");
+}
 
-    int32_t fileCount = gotoCDFH();
-    if(fileCount < 0) return false;
+void ZipFileReader::freeInflater(void) {
+    if(inflater != NULL) {
+        flint->free(inflater);
+        inflater = NULL;
+        discardBuffer();
+    }
+}
 
-    for(uint32_t i = 0; i < fileCount; i++) {
-        uint32_t off = tell();
+int32_t ZipFileReader::fetch(uint32_t offset, uint8_t *dst, uint32_t size) {
+    if(inflater == NULL)
+        return FileReader::fetch(offset, dst, size);
+    int32_t ret = (offset >= dataOffset) ? inflater->read(offset - dataOffset, dst, size) : -1;
+    if(ret < 0 && ctx != NULL)
+        ctx->throwNew(ctx->getFlint()->findClass(ctx, "java/io/IOException"), "Invalid compressed data in %s", filePath);
+    return ret;
+}
 
-        if(!seek(off + 28)) return false;
+bool ZipFileReader::close(void) {
+    freeInflater();
+    return FileReader::close();
+}
 
-        uint16_t nameLen, fieldLen, cmtLen;
-        if(!readUInt16(nameLen)) return false;
-        if(!readUInt16(fieldLen)) return false;
-        if(!readUInt16(cmtLen)) return false;
-
-        uint32_t fileOff;
-        if(!seek(off + 42)) return false;
-        if(!readUInt32(fileOff)) return false;
-
-        if(nameLen == (length + 6)) {
-            bool isOk = true;
-            char buff[16];
-            uint32_t N = length / sizeof(buff);
-            for(uint32_t i = 0; isOk && (i < N); i++) {
-                if(read(buff, sizeof(buff)) != sizeof(buff)) return false;
-                if(strncmp(&name[i * sizeof(buff)], buff, sizeof(buff)) != 0)
-                    isOk = false;
-            }
-            N = length % sizeof(buff);
-            if(isOk && N > 0) {
-                if(read(buff, N) != N) return false;
-                isOk = strncmp(&name[length - N], buff, N) == 0;
-            }
-            if(isOk) {
-                if(read(buff, 6) != 6) return false;
-                isOk = strncmp(".class", buff, 6) == 0;
-            }
-            if(isOk) {
-                if(!seek(fileOff + 26)) return false;
-                if(!readUInt16(nameLen)) return false;
-                if(!readUInt16(fieldLen)) return false;
-                if(!seek(fileOff + 30 + nameLen + fieldLen)) return false;
-                return true;
-            }
-        }
-        if(!seek(off + 46 + nameLen + fieldLen + cmtLen)) return false;
-    }
-    return false;
+bool ZipFileReader::isCompressed(void) const {
+    return inflater != NULL;
+}
+
+const ZipEntry *ZipFileReader::getEntry(void) const {
+    return entry;
 }
@@ -0,0 +1,138 @@
+
+#include <new>
+#include <string.h>
+#include "flint.h"
+#include "flint_common.h"
+#include "flint_file_reader.h"
+#include "flint_zip_index.h"
+
+#define EOCD_SIGNATURE              0x06054B50
+#define CDFH_SIGNATURE              0x02014B50
+#define EOCD_SIZE                   22
+#define CDFH_SIZE                   46
+#define END_OF_CHAIN                0xFFFF
+
+static uint16_t ReadUInt16(const uint8_t *buff) {
+    return buff[0] | (buff[1] << 8);
+}
+
+static uint32_t ReadUInt32(const uint8_t *buff) {
+    return buff[0] | (buff[1] << 8) | (buff[2] << 16) | ((uint32_t)buff[3] << 24);
+}
+
+ZipIndex::ZipIndex(const char *path, uint32_t pathSize, uint16_t capacity, uint16_t bucketCount) :
+DictNode(), hash(Hash(path)), entryCount(0), bucketMask(bucketCount - 1) {
+    strcpy(this->path, path);
+    entries = (ZipEntry *)&this->path[pathSize];
+    buckets = (uint16_t *)&entries[capacity];
+    memset(buckets, 0xFF, bucketCount * sizeof(uint16_t));
+}
+
+uint32_t ZipIndex::getHashKey(void) const {
+    return hash;
+}
+
+int32_t ZipIndex::compareKey(const char *key, uint16_t length) const {
+    return strncmp(path, key, length);
+}
+
+int32_t ZipIndex::compareKey(DictNode *other) const {
+    return strcmp(path, ((ZipIndex *)other)->path);
+}
+
+const char *ZipIndex::getPath(void) const {
+    return path;
+}
+
+uint16_t ZipIndex::getEntryCount(void) const {
+    return entryCount;
+}
+
+const ZipEntry *ZipIndex::findEntry(uint32_t nameHash) const {
+    for(uint16_t i = buckets[nameHash & bucketMask]; i != END_OF_CHAIN; i = entries[i].next) {
+        if(entries[i].hash == nameHash)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+const ZipEntry *ZipIndex::nextEntry(const ZipEntry *entry) const {
+    for(uint16_t i = entry->next; i != END_OF_CHAIN; i = entries[i].next) {
+        if(entries[i].hash == entry->hash)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+void ZipIndex::addEntry(uint32_t nameHash, uint32_t offset, uint32_t compressedSize, uint32_t size, uint16_t method) {
+    ZipEntry *entry = &entries[entryCount];
+    uint16_t bucket = nameHash & bucketMask;
+    entry->hash = nameHash;
+    entry->offset = offset;
+    entry->compressedSize = compressedSize;
+    entry->size = size;
+    entry->method = method;
+    entry->next = buckets[bucket];
+    buckets[bucket] = entryCount++;
+}
+
+bool ZipIndex::readCentralDirectory(FileReader *reader, uint16_t fileCount) {
+    uint8_t buff[CDFH_SIZE];
+    for(uint16_t i = 0; i < fileCount; i++) {
+        if(reader->read(buff, CDFH_SIZE) != CDFH_SIZE) return false;
+        if(ReadUInt32(buff) != CDFH_SIGNATURE) return false;
+        uint16_t method = ReadUInt16(&buff[10]);
+        uint32_t compressedSize = ReadUInt32(&buff[20]);
+        uint32_t size = ReadUInt32(&buff[24]);
+        uint16_t nameLength = ReadUInt16(&buff[28]);
+        uint16_t extraLength = ReadUInt16(&buff[30]);
+        uint16_t commentLength = ReadUInt16(&buff[32]);
+        uint32_t offset = ReadUInt32(&buff[42]);
+
+        uint32_t nameHash = 0;
+        char lastChar = 0;
+        for(uint16_t remain = nameLength; remain > 0;) {
+            uint16_t n = (remain < sizeof(buff)) ? remain : sizeof(buff);
+            if(reader->read(buff, n) != n) return false;
+            nameHash = Hash((const char *)buff, n, nameHash);
+            lastChar = (char)buff[n - 1];
+            remain -= n;
+        }
+        if(!reader->offset(extraLength + commentLength)) return false;
+
+        /* Directories are never looked up */
+        if(nameLength > 0 && lastChar != '/')
+            addEntry(nameHash, offset, compressedSize, size, method);
+    }
+    return true;
+}
+
+ZipIndex *ZipIndex::load(Flint *flint, FileReader *reader) {
+    FExec *ctx = reader->getContext();
+    uint8_t eocd[EOCD_SIZE];
+
+    /* Archive comments are not supported, the end of central directory record must be at the end of the file */
+    uint32_t fileSize = reader->size();
+    if(fileSize < EOCD_SIZE || !reader->seek(fileSize - EOCD_SIZE)) return NULL;
+    if(reader->read(eocd, EOCD_SIZE) != EOCD_SIZE) return NULL;
+    if(ReadUInt32(eocd) != EOCD_SIGNATURE) return NULL;
+    uint16_t fileCount = ReadUInt16(&eocd[10]);
+    uint32_t cdOffset = ReadUInt32(&eocd[16]);
+
+    uint16_t bucketCount = 1;
+    while(bucketCount < fileCount && bucketCount < 0x8000)
+        bucketCount <<= 1;
+
+    const char *path = reader->getFilePath();
+    uint32_t pathSize = (strlen(path) + 1 + 3) & ~0x03;
+    uint32_t size = sizeof(ZipIndex) + pathSize + fileCount * sizeof(ZipEntry) + bucketCount * sizeof(uint16_t);
+    ZipIndex *index = (ZipIndex *)flint->malloc(ctx, size);
+    if(index == NULL) return NULL;
+    new (index)ZipIndex(path, pathSize, fileCount, bucketCount);
+
+    if(!reader->seek(cdOffset) || !index->readCentralDirectory(reader, fileCount)) {
+        flint->free(index);
+        return NULL;
+    }
+    return index;
+}